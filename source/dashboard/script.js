@@ -7,10 +7,23 @@ document.addEventListener('DOMContentLoaded', () => {
     const API_URL = `http://${BROKER_IP}:${BROKER_PORT}/devices/${DEVICE_NAME}`;
     const LATEST_PHOTO_INFO_URL = `http://${BROKER_IP}:${BROKER_PORT}/photos/latest`;
 
-    // Intervalos de atualização
-    const UPDATE_INTERVAL = 2000;
+    // Intervalos de atualização (consultar a 2 Hz é barato: sem dado novo o broker responde 304)
+    const UPDATE_INTERVAL = 500;
     const PHOTO_UPDATE_INTERVAL = 5000;
 
+    // Histórico dos gráficos: 4 h a 2 Hz em anéis de tamanho fixo (a memória não cresce com o tempo)
+    const HISTORY_CAPACITY = 4 * 3600 * 2;
+    const FRAME_STATS_SIZE = 240;          // Últimos redesenhos usados nas estatísticas de tempo de quadro
+
+    // Rastro de latência: idade de cada amostra até ser desenhada, enviada ao broker em lotes
+    const TRACE_REPORT_URL = `${API_URL}/trace/render`;
+    const TRACE_REPORT_INTERVAL = 10000;
+    const TRACE_REPORT_MAX = 100;
+
+    // Comandos: o POST responde 202 com o id; o resultado é consultado até o robô confirmar ou recusar
+    const COMMAND_POLL_INTERVAL = 200;
+    const COMMAND_POLL_TIMEOUT = 6000;     // Um pouco além das retransmissões do broker (COMMAND_WAIT_TIMEOUT)
+
     // --- ELEMENTOS DO DOM ---
     const statusDot = document.getElementById('status-dot');
     const statusText = document.getElementById('status-text');
@@ -29,14 +42,25 @@ document.addEventListener('DOMContentLoaded', () => {
 
     // --- VARIÁVEIS DE ESTADO ---
     let tempHumidityChart, gasLightChart;
+    let redrawPending = false;
+    // ETag do último dado desenhado e foto exibida: com o cache do navegador, o broker responde 304
+    // quando nada mudou e o fetch devolve a mesma resposta, que não precisa ser redesenhada
+    let lastDataEtag = null;
+    let lastPhotoUrl = null;
+    // Amostras recebidas que ainda não foram desenhadas e relatos ainda não enviados
+    let arrivalsAwaitingFrame = [];
+    let traceReports = [];
 
     // --- LÓGICA DE TEMA ---
     const applyTheme = (theme) => {
         document.body.className = theme;
         themeIcon.className = theme === 'light-mode' ? 'fa-regular fa-sun' : 'fa-regular fa-moon';
-        if (tempHumidityChart) tempHumidityChart.destroy();
-        if (gasLightChart) gasLightChart.destroy();
-        initializeCharts();
+        // Só troca as cores: os dados ficam nos anéis e os gráficos não são recriados
+        if (tempHumidityChart) {
+            applyChartTheme();
+        } else {
+            initializeCharts();
+        }
     };
 
     themeToggleButton.addEventListener('click', () => {
@@ -56,51 +80,201 @@ document.addEventListener('DOMContentLoaded', () => {
         };
     };
 
+    // Série temporal em anel: instantes e valores em typed arrays de capacidade fixa
+    class SeriesRing {
+        constructor(capacity, channels) {
+            this.capacity = capacity;
+            this.times = new Float64Array(capacity);
+            this.values = Array.from({ length: channels }, () => new Float32Array(capacity));
+            this.start = 0;
+            this.length = 0;
+        }
+
+        push(time, values) {
+            const index = (this.start + this.length) % this.capacity;
+            this.times[index] = time;
+            this.values.forEach((channel, c) => { channel[index] = values[c]; });
+            if (this.length < this.capacity) {
+                this.length++;
+            } else {
+                this.start = (this.start + 1) % this.capacity;
+            }
+        }
+
+        clear() {
+            this.start = 0;
+            this.length = 0;
+        }
+
+        // Dizimação min/max: divide o histórico em 'buckets' colunas (uma por pixel) e mantém, em
+        // ordem de tempo, o menor e o maior valor de cada coluna, então picos curtos não somem.
+        // Custo O(n) e no máximo 2 pontos por pixel, qualquer que seja o tamanho do histórico.
+        decimate(channel, buckets, out) {
+            const values = this.values[channel];
+            out.length = 0;
+            if (this.length <= 2 * buckets) {
+                for (let i = 0; i < this.length; i++) {
+                    const index = (this.start + i) % this.capacity;
+                    out.push({ x: this.times[index], y: values[index] });
+                }
+                return out;
+            }
+            const perBucket = this.length / buckets;
+            for (let b = 0; b < buckets; b++) {
+                const first = Math.floor(b * perBucket);
+                const last = Math.min(this.length, Math.floor((b + 1) * perBucket));
+                let minIndex = (this.start + first) % this.capacity;
+                let maxIndex = minIndex;
+                for (let i = first + 1; i < last; i++) {
+                    const index = (this.start + i) % this.capacity;
+                    if (values[index] < values[minIndex]) minIndex = index;
+                    if (values[index] > values[maxIndex]) maxIndex = index;
+                }
+                const a = this.times[minIndex] <= this.times[maxIndex] ? minIndex : maxIndex;
+                const z = a === minIndex ? maxIndex : minIndex;
+                out.push({ x: this.times[a], y: values[a] });
+                if (z !== a) out.push({ x: this.times[z], y: values[z] });
+            }
+            return out;
+        }
+    }
+
+    const tempHumidityHistory = new SeriesRing(HISTORY_CAPACITY, 2);
+    const gasLightHistory = new SeriesRing(HISTORY_CAPACITY, 2);
+
+    // Tempo gasto em cada redesenho (dizimação + chart.update), para acompanhar no console
+    const frameTimes = new Float32Array(FRAME_STATS_SIZE);
+    let frameCount = 0;
+    let pointsDrawn = 0;
+
     const createChart = (canvasId, datasetsConfig) => {
-        const colors = getChartColors();
         const ctx = document.getElementById(canvasId).getContext('2d');
         return new Chart(ctx, {
             type: 'line',
-            data: { labels: [], datasets: datasetsConfig },
+            data: { datasets: datasetsConfig },
             options: {
                 responsive: true, maintainAspectRatio: false,
+                // Os pontos já chegam dizimados e ordenados: sem animação, parsing ou curvas a recalcular
+                animation: false, parsing: false, normalized: true,
                 scales: {
-                    x: { ticks: { color: colors.textSecondary }, grid: { color: colors.borderColor } },
-                    y: { ticks: { color: colors.textSecondary }, grid: { color: colors.borderColor } }
+                    x: { type: 'linear', grid: {}, ticks: { maxTicksLimit: 8, callback: (value) => new Date(value).toLocaleTimeString('pt-BR') } },
+                    y: { grid: {}, ticks: {} }
                 },
-                plugins: { legend: { labels: { color: colors.textColor, font: { family: "'DM Sans', sans-serif" } } } },
-                interaction: { intersect: false, mode: 'index' }
+                plugins: { legend: { labels: { font: { family: "'DM Sans', sans-serif" } } } },
+                interaction: { intersect: false, mode: 'nearest', axis: 'x' }
             }
         });
     };
 
-    const initializeCharts = () => {
+    const applyChartTheme = () => {
         const colors = getChartColors();
-        const commonOptions = { borderWidth: 2, fill: true, tension: 0.4, pointRadius: 0, pointHoverRadius: 5 };
+        const seriesColors = [[colors.accent, colors.accentLight], ['#FFB547', '#39A2DB']];
+        [tempHumidityChart, gasLightChart].forEach((chart, c) => {
+            Object.values(chart.options.scales).forEach((scale) => {
+                scale.ticks.color = colors.textSecondary;
+                scale.grid.color = colors.borderColor;
+            });
+            chart.options.plugins.legend.labels.color = colors.textColor;
+            chart.data.datasets.forEach((dataset, d) => {
+                dataset.borderColor = seriesColors[c][d];
+                dataset.backgroundColor = `${seriesColors[c][d]}33`;
+            });
+            chart.update('none');
+        });
+    };
+
+    const initializeCharts = () => {
+        const commonOptions = { borderWidth: 2, fill: true, tension: 0, pointRadius: 0, pointHoverRadius: 5 };
         tempHumidityChart = createChart('tempHumidityChart', [
-            { label: 'Temperatura (°C)', data: [], borderColor: colors.accent, backgroundColor: `${colors.accent}33`, ...commonOptions },
-            { label: 'Umidade (%)', data: [], borderColor: colors.accentLight, backgroundColor: `${colors.accentLight}33`, ...commonOptions }
+            { label: 'Temperatura (°C)', data: [], ...commonOptions },
+            { label: 'Umidade (%)', data: [], ...commonOptions }
         ]);
         gasLightChart = createChart('gasLightChart', [
-            { label: 'Gás (ppm)', data: [], borderColor: '#FFB547', backgroundColor: '#FFB54733', ...commonOptions },
-            { label: 'Luz (cd)', data: [], borderColor: '#39A2DB', backgroundColor: '#39A2DB33', ...commonOptions }
+            { label: 'Gás (ppm)', data: [], ...commonOptions },
+            { label: 'Luz (cd)', data: [], ...commonOptions }
         ]);
+        applyChartTheme();
     };
 
-    const updateChartData = (chart, newLabel, newValues) => {
-        if (!chart) return;
-        chart.data.labels.push(newLabel);
-        chart.data.datasets.forEach((dataset, index) => dataset.data.push(newValues[index]));
-        if (chart.data.labels.length > 30) {
-            chart.data.labels.shift();
-            chart.data.datasets.forEach(dataset => dataset.data.shift());
-        }
-        chart.update();
+    const redrawChart = (chart, history) => {
+        const buckets = Math.max(1, Math.floor(chart.chartArea ? chart.chartArea.right - chart.chartArea.left : chart.width));
+        chart.data.datasets.forEach((dataset, channel) => {
+            history.decimate(channel, buckets, dataset.data);
+            pointsDrawn += dataset.data.length;
+        });
+        chart.update('none');
+    };
+
+    // Redesenho em lote: várias amostras entre dois quadros geram um único redesenho
+    const scheduleRedraw = () => {
+        if (redrawPending) return;
+        redrawPending = true;
+        requestAnimationFrame(() => {
+            redrawPending = false;
+            if (!tempHumidityChart) return;
+            const start = performance.now();
+            pointsDrawn = 0;
+            redrawChart(tempHumidityChart, tempHumidityHistory);
+            redrawChart(gasLightChart, gasLightHistory);
+            const drawn = performance.now();
+            frameTimes[frameCount % FRAME_STATS_SIZE] = drawn - start;
+            frameCount++;
+            arrivalsAwaitingFrame.forEach((arrival) => {
+                if (traceReports.length < TRACE_REPORT_MAX) {
+                    traceReports.push({ age_ms: arrival.age_ms, fetch_ms: arrival.fetch_ms, render_ms: drawn - arrival.arrived });
+                }
+            });
+            arrivalsAwaitingFrame = [];
+        });
     };
 
+    const updateChartData = (time, tempHumidity, gasLight) => {
+        tempHumidityHistory.push(time, tempHumidity);
+        gasLightHistory.push(time, gasLight);
+        scheduleRedraw();
+    };
+
+    // Estatísticas dos últimos redesenhos: no console, dashboardStats()
+    const frameStats = () => {
+        const count = Math.min(frameCount, FRAME_STATS_SIZE);
+        const ordered = Array.from(frameTimes.subarray(0, count)).sort((a, b) => a - b);
+        const pick = (p) => (count ? +ordered[Math.min(count - 1, Math.floor(p * count))].toFixed(2) : null);
+        return {
+            frames: frameCount, samples: tempHumidityHistory.length, capacity: HISTORY_CAPACITY,
+            points_drawn: pointsDrawn, p50_ms: pick(0.5), p95_ms: pick(0.95), max_ms: count ? +ordered[count - 1].toFixed(2) : null
+        };
+    };
+    window.dashboardStats = frameStats;
+
+    // Carga sintética: enche os anéis com 'hours' horas a 2 Hz e mede 'frames' redesenhos.
+    // No console: await dashboardBenchmark(4). Os dados reais voltam a entrar nas próximas leituras.
+    window.dashboardBenchmark = (hours = 4, frames = 120) => new Promise((resolve) => {
+        const samples = Math.min(HISTORY_CAPACITY, Math.round(hours * 3600 * 2));
+        const end = Date.now();
+        tempHumidityHistory.clear();
+        gasLightHistory.clear();
+        for (let i = 0; i < samples; i++) {
+            const t = i / 7200;
+            tempHumidityHistory.push(end - (samples - i) * 500, [25 + 5 * Math.sin(t * 6) + Math.random(), 60 + 10 * Math.cos(t * 4)]);
+            gasLightHistory.push(end - (samples - i) * 500, [80 + 20 * Math.random(), 500 + 300 * Math.sin(t * 2)]);
+        }
+        frameCount = 0;
+        let left = frames;
+        const step = () => {
+            scheduleRedraw();
+            if (--left > 0) {
+                requestAnimationFrame(step);
+            } else {
+                requestAnimationFrame(() => resolve(frameStats()));
+            }
+        };
+        step();
+    });
+
     // --- LÓGICA DE DADOS (ATUALIZADA COM MELHOR FEEDBACK) ---
     const updateDashboard = async () => {
         try {
+            const fetchStart = performance.now();
             const response = await fetch(`${API_URL}/data`);
             const responseData = await response.json();
 
@@ -119,9 +293,25 @@ document.addEventListener('DOMContentLoaded', () => {
             
             statusDot.className = 'dot connected';
             statusText.textContent = 'Online e recebendo dados';
-            
+
+            const etag = response.headers.get('ETag');
+            if (etag && etag === lastDataEtag) {
+                return;
+            }
+            lastDataEtag = etag;
+
+            // Idade da amostra quando o broker a entregou (desde a captura no ADC, se o relógio do robô está sincronizado)
+            const age = parseFloat(response.headers.get('X-Sample-Age-Ms'));
+            if (!Number.isNaN(age)) {
+                const arrived = performance.now();
+                arrivalsAwaitingFrame.push({ age_ms: age, fetch_ms: arrived - fetchStart, arrived });
+            }
+
+            // Eixo x no instante da captura; sem relógio sincronizado, no da chegada
+            const trace = responseData.trace;
+            const time = trace && trace.captured_at ? trace.captured_at * 1000 : Date.now();
             const { life_chance, temp, hum, gas, lux, terrain_status } = responseData.data;
-            updateUI(life_chance, temp, hum, gas, lux, terrain_status);
+            updateUI(life_chance, temp, hum, gas, lux, terrain_status, time);
 
         } catch (error) {
             console.error("Erro ao atualizar dashboard:", error);
@@ -130,7 +320,7 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     };
     
-    const updateUI = (lifeProb, temp, humidity, gas, light, classification) => {
+    const updateUI = (lifeProb, temp, humidity, gas, light, classification, time) => {
         const colors = getChartColors();
         lifeProbValue.textContent = `${Math.round(lifeProb * 100)}%`;
         classificationText.textContent = `Classificação: ${classification}`;
@@ -142,9 +332,23 @@ document.addEventListener('DOMContentLoaded', () => {
         const angle = lifeProb * 360;
         gaugeFill.style.background = `conic-gradient(${colors.accent} ${angle}deg, ${colors.borderColor} ${angle}deg)`;
 
-        const currentTime = new Date().toLocaleTimeString('pt-BR');
-        updateChartData(tempHumidityChart, currentTime, [temp, humidity]);
-        updateChartData(gasLightChart, currentTime, [gas, light]);
+        updateChartData(time, [temp, humidity], [gas, light]);
+    };
+
+    // Relatos de renderização: o broker junta ao rastro da amostra (etapas 'render' e 'end_to_end')
+    const sendTraceReports = async () => {
+        if (traceReports.length === 0) return;
+        const reports = traceReports;
+        traceReports = [];
+        try {
+            await fetch(TRACE_REPORT_URL, {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({ reports })
+            });
+        } catch (error) {
+            console.warn("Relatos de latência não enviados:", error);
+        }
     };
 
     // --- FUNÇÃO DE FOTO (ATUALIZADA COM MELHOR FEEDBACK) ---
@@ -158,8 +362,11 @@ document.addEventListener('DOMContentLoaded', () => {
             }
             const data = await response.json();
             if (data && data.photo_url) {
-                const fullPhotoUrl = `http://${BROKER_IP}:${BROKER_PORT}${data.photo_url}?t=${new Date().getTime()}`;
-                robotPhoto.src = fullPhotoUrl;
+                // Cada foto tem um nome novo: só troca a imagem (e a baixa de novo) quando a URL muda
+                if (data.photo_url !== lastPhotoUrl) {
+                    lastPhotoUrl = data.photo_url;
+                    robotPhoto.src = `http://${BROKER_IP}:${BROKER_PORT}${data.photo_url}?t=${new Date().getTime()}`;
+                }
                 robotPhoto.style.display = 'block';
                 photoStatusText.style.display = 'none';
             } else {
@@ -175,6 +382,18 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     };
 
+    // Consulta o comando até sair de 'pending' (ou até o prazo, devolvendo o último estado visto)
+    const waitForCommand = async (commandId) => {
+        const deadline = performance.now() + COMMAND_POLL_TIMEOUT;
+        let result = { status: 'pending' };
+        while (result.status === 'pending' && performance.now() < deadline) {
+            await new Promise(resolve => setTimeout(resolve, COMMAND_POLL_INTERVAL));
+            const response = await fetch(`${API_URL}/commands/${commandId}`, { cache: 'no-store' });
+            result = await response.json();
+        }
+        return result;
+    };
+
      stopButton.addEventListener('click', async () => {
         try {
             const response = await fetch(`${API_URL}/command`, {
@@ -182,12 +401,20 @@ document.addEventListener('DOMContentLoaded', () => {
                 headers: { 'Content-Type': 'application/json' },
                 body: JSON.stringify({ command_type: 'toggle_system_state' })
             });
-            const result = await response.json();
-            if(response.ok) {
+            const sent = await response.json();
+            if (response.status !== 202) {
+                alert('Falha ao enviar comando: ' + sent.error);
+                return;
+            }
+            const result = await waitForCommand(sent.id);
+            if (result.status === 'acked') {
                 // Em um ambiente real, você usaria uma modalbox personalizada em vez de alert()
-                alert('Comando enviado com sucesso: ' + result.message); 
+                const state = result.system_on ? 'ligado' : 'desligado';
+                alert(`Comando aplicado. Sistema ${state} em ${result.latency_ms} ms (${result.attempts} tentativa(s)).`);
+            } else if (result.status === 'rejected') {
+                alert('O robô recusou o comando: ' + result.error);
             } else {
-                alert('Falha ao enviar comando: ' + result.error);
+                alert('Comando enviado, mas o robô não confirmou a aplicação.');
             }
         } catch (error) {
             alert('Erro de conexão ao enviar comando.');
@@ -201,4 +428,5 @@ document.addEventListener('DOMContentLoaded', () => {
     updatePhoto();
     setInterval(updateDashboard, UPDATE_INTERVAL);
     setInterval(updatePhoto, PHOTO_UPDATE_INTERVAL);
+    setInterval(sendTraceReports, TRACE_REPORT_INTERVAL);
 });
\ No newline at end of file
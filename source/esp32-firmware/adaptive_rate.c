@@ -0,0 +1,97 @@
+#include "adaptive_rate.h"
+
+#include <math.h>
+
+#include "ia_model.h"
+
+
+void rate_init(RateController *rate, const RateConfig *config) {
+    rate->config = *config;
+    rate->interval_ms = config->base_interval_ms;
+    rate->active = 0;
+    rate->quiet_count = 0;
+    rate->last_delta = 0.0f;
+    rate->has_input = 0;
+    rate->has_life_chance = 0;
+    rate->last_life_chance = 0.0f;
+    rate->transitions = 0;
+}
+
+/* Registra a leitura normalizada. Retorna 1 se a variação já basta para ativar (a IA deve rodar nesta leitura). */
+int rate_observe(RateController *rate, const float input[RATE_CHANNELS]) {
+    float delta = 0.0f;
+
+    if (rate->has_input) {
+        for (int c = 0; c < RATE_CHANNELS; ++c) {
+            float d = fabsf(input[c] - rate->last_input[c]);
+            if (d > delta) delta = d;
+        }
+    }
+    for (int c = 0; c < RATE_CHANNELS; ++c) {
+        rate->last_input[c] = input[c];
+    }
+    rate->has_input = 1;
+    rate->last_delta = delta;
+    return delta > rate->config.enter_delta;
+}
+
+static int near_boundary(float life_chance, float margin) {
+    return fabsf(life_chance - LIFE_THRESHOLD_MODERATE) < margin
+        || fabsf(life_chance - LIFE_THRESHOLD_FAVORABLE) < margin;
+}
+
+/* Fecha a leitura com a chance de vida (se a IA rodou) e retorna o intervalo até a próxima */
+unsigned long rate_update(RateController *rate, float life_chance, int predicted) {
+    const RateConfig *config = &rate->config;
+    float delta = rate->last_delta, slope = 0.0f;
+
+    if (predicted) {
+        if (rate->has_life_chance) {
+            slope = fabsf(life_chance - rate->last_life_chance);
+        }
+        rate->last_life_chance = life_chance;
+        rate->has_life_chance = 1;
+    }
+
+    if (delta > config->enter_delta || slope > config->enter_slope) {
+        // Mudança rápida: vai direto para a taxa máxima
+        if (!rate->active) {
+            rate->transitions++;
+        }
+        rate->active = 1;
+        rate->quiet_count = 0;
+        rate->interval_ms = config->min_interval_ms;
+        return rate->interval_ms;
+    }
+
+    if (delta >= config->exit_delta || slope >= config->exit_slope) {
+        // Zona de histerese: mantém o intervalo atual
+        rate->quiet_count = 0;
+    } else if (++rate->quiet_count >= config->quiet_hold) {
+        rate->quiet_count = 0;
+        if (rate->active) {
+            rate->active = 0;
+            rate->interval_ms = config->base_interval_ms;
+        } else if (rate->interval_ms < config->max_interval_ms) {
+            rate->interval_ms *= 2;
+            if (rate->interval_ms > config->max_interval_ms) {
+                rate->interval_ms = config->max_interval_ms;
+            }
+        }
+    }
+
+    // Perto de mudar de classe: não espera mais que o intervalo base
+    if (!rate->active && rate->has_life_chance && rate->interval_ms > config->base_interval_ms
+        && near_boundary(rate->last_life_chance, config->boundary_margin)) {
+        rate->interval_ms = config->base_interval_ms;
+    }
+    return rate->interval_ms;
+}
+
+/* Intervalo da IA: toda leitura no modo ativo; fora dele, escala com o intervalo de amostragem */
+unsigned long rate_prediction_interval(const RateController *rate, unsigned long base_prediction_ms) {
+    if (rate->active) {
+        return rate->interval_ms;
+    }
+    return base_prediction_ms * rate->interval_ms / rate->config.base_interval_ms;
+}
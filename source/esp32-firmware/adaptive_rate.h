@@ -0,0 +1,68 @@
+/*
+* Controle adaptativo da taxa de amostragem e da IA.
+*
+* Em vez de ler os sensores sempre a cada SENSOR_READ_INTERVAL, o intervalo acompanha a atividade
+* do sinal: se algum canal (normalizado 0-1) varia mais que 'enter_delta' entre duas leituras, ou a
+* chance de vida varia mais que 'enter_slope' entre duas predições, o controlador entra em modo
+* ativo, cai direto para o intervalo mínimo e roda a IA em toda leitura (inclusive na que disparou).
+* Ele só volta ao modo calmo depois de 'quiet_hold' leituras seguidas abaixo dos limiares de saída
+* (menores que os de entrada, para não oscilar), e a partir daí dobra o intervalo a cada 'quiet_hold'
+* leituras calmas até o máximo. Leituras entre os dois limiares só zeram a contagem, e uma chance de
+* vida a menos de 'boundary_margin' de um limiar de classificação segura o intervalo no base.
+*
+* Uso em cada leitura: rate_observe() com a entrada normalizada (retorna 1 se a IA deve rodar já),
+* a predição, se houver, e então rate_update() para obter o intervalo até a próxima leitura.
+* Os intervalos devem ser múltiplos de COMMAND_POLL_INTERVAL no firmware.
+*/
+
+#ifndef ADAPTIVE_RATE_H
+#define ADAPTIVE_RATE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RATE_CHANNELS 4
+
+typedef struct {
+    unsigned long min_interval_ms;
+    unsigned long base_interval_ms;     // Intervalo ao sair do modo ativo
+    unsigned long max_interval_ms;
+    float enter_delta;                  // Variação normalizada de um canal que ativa
+    float exit_delta;                   // ... e abaixo da qual a leitura conta como calma
+    float enter_slope;                  // Variação da chance de vida entre predições que ativa
+    float exit_slope;
+    float boundary_margin;              // Distância aos limiares 0,5 / 0,70 que segura o intervalo
+    unsigned int quiet_hold;            // Leituras calmas seguidas para sair do ativo / dobrar o intervalo
+} RateConfig;
+
+/* Valores padrão em torno de um intervalo base (metade do base a 4x o base) */
+#define RATE_CONFIG_DEFAULT(base_ms) { (base_ms) / 2, (base_ms), (base_ms) * 4, \
+                                       0.02f, 0.008f, 0.04f, 0.015f, 0.02f, 8 }
+
+typedef struct {
+    RateConfig config;
+    unsigned long interval_ms;          // Intervalo até a próxima leitura
+    uint8_t active;
+    unsigned int quiet_count;
+    float last_input[RATE_CHANNELS];
+    float last_delta;                   // Maior variação de canal na última leitura
+    float last_life_chance;
+    uint8_t has_input;
+    uint8_t has_life_chance;
+    unsigned long transitions;          // Entradas no modo ativo (diagnóstico)
+} RateController;
+
+/* Prototipo de funções*/
+void rate_init(RateController *rate, const RateConfig *config);
+int rate_observe(RateController *rate, const float input[RATE_CHANNELS]);
+unsigned long rate_update(RateController *rate, float life_chance, int predicted);
+unsigned long rate_prediction_interval(const RateController *rate, unsigned long base_prediction_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADAPTIVE_RATE_H
@@ -0,0 +1,288 @@
+#include "async_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_MESSAGE_FORMAT(id, format) format,
+
+static const char *const log_formats[LOG_MESSAGE_COUNT] = {
+    LOG_MESSAGES(LOG_MESSAGE_FORMAT)
+};
+
+static const char *const log_level_prefix[] = { "[DEBUG] ", "", "[AVISO] ", "[ERRO] " };
+
+/* Posição do anel: 'sequence' diz a quem ela pertence (ver log_write/log_pop) */
+typedef struct {
+    uint32_t sequence;
+    LogRecord record;
+} LogSlot;
+
+static LogSlot ring[LOG_RING_SIZE];
+static uint32_t ring_head;          // Próxima posição a reservar (produtores, via CAS)
+static uint32_t ring_tail;          // Próxima posição a ler (só a tarefa de log)
+static uint32_t ring_dropped;
+static uint32_t (*log_clock)(void);
+
+
+void log_init(uint32_t (*clock_ms)(void)) {
+    for (uint32_t i = 0; i < LOG_RING_SIZE; ++i) {
+        ring[i].sequence = i;
+    }
+    ring_head = 0;
+    ring_tail = 0;
+    ring_dropped = 0;
+    log_clock = clock_ms;
+}
+
+/* Lado dos produtores: reserva uma posição livre e publica o registro. Retorna 0 se o anel estiver cheio. */
+int log_write(uint8_t level, uint16_t id, uint8_t nargs, const LogArg *args) {
+    uint32_t pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+    LogSlot *slot;
+
+    for (;;) {
+        slot = &ring[pos & (LOG_RING_SIZE - 1)];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            // Posição livre: tenta reservá-la; se outro produtor ganhou, 'pos' volta atualizado
+            if (__atomic_compare_exchange_n(&ring_head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // A tarefa de log ainda não liberou esta posição: anel cheio
+            __atomic_fetch_add(&ring_dropped, 1, __ATOMIC_RELAXED);
+            return 0;
+        } else {
+            pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->record.timestamp_ms = log_clock ? log_clock() : 0;
+    slot->record.id = id;
+    slot->record.level = level;
+    slot->record.nargs = nargs > LOG_MAX_ARGS ? LOG_MAX_ARGS : nargs;
+    memcpy(slot->record.args, args, slot->record.nargs * sizeof(LogArg));
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Lado da tarefa de log. Retorna 0 se não houver registro publicado. */
+int log_pop(LogRecord *record) {
+    LogSlot *slot = &ring[ring_tail & (LOG_RING_SIZE - 1)];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != ring_tail + 1) {
+        return 0;
+    }
+    *record = slot->record;
+    __atomic_store_n(&slot->sequence, ring_tail + LOG_RING_SIZE, __ATOMIC_RELEASE);
+    ring_tail++;
+    return 1;
+}
+
+uint32_t log_dropped(void) {
+    return __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+}
+
+const char *log_message_format(uint16_t id) {
+    return id < LOG_MESSAGE_COUNT ? log_formats[id] : NULL;
+}
+
+/* Próxima especificação de conversão a partir de format[i] == '%'. Copia em 'spec' sem os
+* modificadores de tamanho (todos os argumentos têm 32 bits) e retorna o caractere de conversão. */
+static char next_spec(const char *format, size_t *i, char *spec, size_t capacity) {
+    size_t n = 0;
+    spec[n++] = format[(*i)++];
+    while (format[*i] && strchr("-+ #0123456789.lhzjt", format[*i])) {
+        if (!strchr("lhzjt", format[*i]) && n + 2 < capacity) {
+            spec[n++] = format[*i];
+        }
+        (*i)++;
+    }
+    char conversion = format[*i];
+    if (conversion) {
+        (*i)++;
+    }
+    spec[n++] = conversion;
+    spec[n] = '\0';
+    return conversion;
+}
+
+/* printf adiado: formata um argumento por vez, com o tipo tirado da própria conversão */
+size_t log_format(char *out, size_t capacity, const char *format, const LogArg *args, uint8_t nargs) {
+    size_t length = 0, i = 0;
+    uint8_t next = 0;
+
+    if (capacity == 0) {
+        return 0;
+    }
+    while (format[i] && length + 1 < capacity) {
+        if (format[i] != '%') {
+            out[length++] = format[i++];
+            continue;
+        }
+        if (format[i + 1] == '%') {
+            out[length++] = '%';
+            i += 2;
+            continue;
+        }
+        char spec[16];
+        char conversion = next_spec(format, &i, spec, sizeof(spec));
+        LogArg arg;
+        arg.u = 0;
+        if (next < nargs) {
+            arg = args[next];
+        }
+        next++;
+
+        int written;
+        switch (conversion) {
+            case 'd': case 'i': case 'c':
+                written = snprintf(out + length, capacity - length, spec, (int)arg.i);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                written = snprintf(out + length, capacity - length, spec, (unsigned int)arg.u);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                written = snprintf(out + length, capacity - length, spec, (double)arg.f);
+                break;
+            case 's':
+                written = snprintf(out + length, capacity - length, spec, arg.s ? arg.s : "(null)");
+                break;
+            default:
+                written = 0;
+                break;
+        }
+        if (written < 0) {
+            break;
+        }
+        length += (size_t)written < capacity - length ? (size_t)written : capacity - length - 1;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/* Linha de texto do modo normal: "[instante] mensagem\n" */
+size_t log_format_record(const LogRecord *record, char *out, size_t capacity) {
+    const char *format = log_message_format(record->id);
+    int prefix = snprintf(out, capacity, "[%8lu] %s", (unsigned long)record->timestamp_ms,
+                          record->level <= LOG_LEVEL_ERROR ? log_level_prefix[record->level] : "");
+    if (prefix < 0 || (size_t)prefix + 2 > capacity) {
+        return 0;
+    }
+    size_t length = (size_t)prefix;
+    if (format) {
+        length += log_format(out + length, capacity - length - 1, format, record->args, record->nargs);
+    } else {
+        length += (size_t)snprintf(out + length, capacity - length - 1, "(mensagem %u)", record->id);
+    }
+    out[length++] = '\n';
+    out[length] = '\0';
+    return length;
+}
+
+/* Quadro binário (formato em async_log.h). Retorna 0 se não couber em 'capacity'. */
+size_t log_encode_record(const LogRecord *record, uint8_t *out, size_t capacity) {
+    const char *format = log_message_format(record->id);
+    size_t n = 0, i = 0;
+    uint8_t arg = 0;
+
+    if (!format || capacity < 11) {
+        return 0;
+    }
+    out[n++] = LOG_SYNC_0;
+    out[n++] = LOG_SYNC_1;
+    out[n++] = record->id & 0xFF;
+    out[n++] = record->id >> 8;
+    out[n++] = record->level;
+    for (int b = 0; b < 4; ++b) out[n++] = (record->timestamp_ms >> (8 * b)) & 0xFF;
+    out[n++] = record->nargs;
+
+    // Strings vão por extenso (o ponteiro não vale no host); o resto, como a palavra de 32 bits
+    while (format[i] && arg < record->nargs) {
+        if (format[i] != '%' || format[i + 1] == '%') {
+            i += format[i] == '%' ? 2 : 1;
+            continue;
+        }
+        char spec[16];
+        char conversion = next_spec(format, &i, spec, sizeof(spec));
+        LogArg value = record->args[arg++];
+        if (conversion == 's') {
+            const char *s = value.s ? value.s : "";
+            size_t length = strlen(s);
+            if (length > LOG_MAX_STRING) length = LOG_MAX_STRING;
+            if (n + 1 + length + 1 > capacity) return 0;
+            out[n++] = (uint8_t)length;
+            memcpy(out + n, s, length);
+            n += length;
+        } else {
+            if (n + 4 + 1 > capacity) return 0;
+            for (int b = 0; b < 4; ++b) out[n++] = (value.u >> (8 * b)) & 0xFF;
+        }
+    }
+
+    out[9] = arg;   // Argumentos realmente codificados
+
+    uint8_t sum = 0;
+    for (size_t k = 2; k < n; ++k) sum += out[k];
+    out[n++] = sum;
+    return n;
+}
+
+/* Decodifica um quadro binário que começa em in[0] (usado pelo host). Os %s são copiados para
+* 'strings' e apontados em record->args. Retorna os bytes consumidos, 0 se o quadro ainda estiver
+* incompleto ou -1 se não for um quadro válido (o chamador pula um byte e procura a sincronização). */
+int log_decode_frame(const uint8_t *in, size_t length, LogRecord *record, char *strings, size_t capacity) {
+    size_t n = 10, i = 0, used = 0;
+    uint8_t arg = 0;
+
+    if (length < 2) {
+        return 0;
+    }
+    if (in[0] != LOG_SYNC_0 || in[1] != LOG_SYNC_1) {
+        return -1;
+    }
+    if (length < n) {
+        return 0;
+    }
+    record->id = (uint16_t)(in[2] | (in[3] << 8));
+    record->level = in[4];
+    record->timestamp_ms = (uint32_t)in[5] | ((uint32_t)in[6] << 8) | ((uint32_t)in[7] << 16) | ((uint32_t)in[8] << 24);
+    record->nargs = in[9];
+    const char *format = log_message_format(record->id);
+    if (!format || record->nargs > LOG_MAX_ARGS) {
+        return -1;
+    }
+
+    while (format[i] && arg < record->nargs) {
+        if (format[i] != '%' || format[i + 1] == '%') {
+            i += format[i] == '%' ? 2 : 1;
+            continue;
+        }
+        char spec[16];
+        char conversion = next_spec(format, &i, spec, sizeof(spec));
+        LogArg *value = &record->args[arg++];
+        if (conversion == 's') {
+            if (n + 1 > length) return 0;
+            size_t size = in[n++];
+            if (size > LOG_MAX_STRING || used + size + 1 > capacity) return -1;
+            if (n + size > length) return 0;
+            memcpy(strings + used, in + n, size);
+            strings[used + size] = '\0';
+            value->s = strings + used;
+            used += size + 1;
+            n += size;
+        } else {
+            if (n + 4 > length) return 0;
+            value->u = (uint32_t)in[n] | ((uint32_t)in[n + 1] << 8) | ((uint32_t)in[n + 2] << 16) | ((uint32_t)in[n + 3] << 24);
+            n += 4;
+        }
+    }
+    if (arg != record->nargs) {
+        return -1;
+    }
+    if (n + 1 > length) {
+        return 0;
+    }
+
+    uint8_t sum = 0;
+    for (size_t k = 2; k < n; ++k) sum += in[k];
+    return sum == in[n] ? (int)(n + 1) : -1;
+}
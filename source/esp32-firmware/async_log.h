@@ -0,0 +1,122 @@
+/*
+* Log assíncrono com formatação adiada.
+*
+* A 9600 baud a serial escreve ~1 byte/ms: um Serial.printf por linha trava quem chama assim que
+* o FIFO da UART enche. Aqui a chamada de log só grava um registro pequeno (id da mensagem,
+* nível, instante e até LOG_MAX_ARGS argumentos de 32 bits) num anel sem trava, e uma tarefa de
+* baixa prioridade tira os registros, formata e escreve na serial. Com o anel cheio o registro é
+* descartado e contado; a tarefa de log informa os descartes.
+*
+* - Níveis em tempo de compilação: chamadas abaixo de LOG_LEVEL somem do binário.
+* - Vários produtores (as tarefas dos dois núcleos) e um consumidor (a tarefa de log): cada posição
+*   do anel tem um número de sequência, o produtor reserva a posição com CAS no 'head' e a publica
+*   com release na sequência.
+* - Modo binário: log_encode_record() gera quadros compactos que o host decodifica com
+*   source/host/log_decode.c usando a mesma tabela de mensagens (log_messages.h).
+*
+* Formato do quadro binário (inteiros little-endian):
+*   [LOG_SYNC_0][LOG_SYNC_1][id u16][nível u8][instante ms u32][n. args u8][args...][soma u8]
+*   cada argumento numérico ocupa 4 bytes; %s vai como [tamanho u8][bytes...];
+*   'soma' é a soma módulo 256 dos bytes entre a sincronização e ela.
+*/
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log_messages.h"
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_MAX_ARGS 4
+#define LOG_RING_SIZE 64            // Registros (potência de 2); ~2 ciclos completos de leitura
+#define LOG_MAX_LINE 160
+#define LOG_MAX_STRING 48           // Maior %s copiado no modo binário
+#define LOG_SYNC_0 0xA5
+#define LOG_SYNC_1 0x5A
+#define LOG_MAX_FRAME (10 + LOG_MAX_ARGS * (1 + LOG_MAX_STRING) + 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef union {
+    int32_t i;
+    uint32_t u;
+    float f;
+    const char *s;
+} LogArg;
+
+typedef struct {
+    uint32_t timestamp_ms;
+    uint16_t id;                    // LogMessageId
+    uint8_t level;
+    uint8_t nargs;
+    LogArg args[LOG_MAX_ARGS];
+} LogRecord;
+
+/* Prototipo de funções*/
+void log_init(uint32_t (*clock_ms)(void));
+int log_write(uint8_t level, uint16_t id, uint8_t nargs, const LogArg *args);
+int log_pop(LogRecord *record);
+uint32_t log_dropped(void);
+
+const char *log_message_format(uint16_t id);
+size_t log_format(char *out, size_t capacity, const char *format, const LogArg *args, uint8_t nargs);
+size_t log_format_record(const LogRecord *record, char *out, size_t capacity);
+size_t log_encode_record(const LogRecord *record, uint8_t *out, size_t capacity);
+int log_decode_frame(const uint8_t *in, size_t length, LogRecord *record, char *strings, size_t capacity);
+
+#ifdef __cplusplus
+}
+
+/* Conversão dos argumentos (C++: o sketch .ino) */
+static inline LogArg log_arg(int value) { LogArg arg; arg.i = (int32_t)value; return arg; }
+static inline LogArg log_arg(unsigned int value) { LogArg arg; arg.u = (uint32_t)value; return arg; }
+static inline LogArg log_arg(long value) { LogArg arg; arg.i = (int32_t)value; return arg; }
+static inline LogArg log_arg(unsigned long value) { LogArg arg; arg.u = (uint32_t)value; return arg; }
+static inline LogArg log_arg(float value) { LogArg arg; arg.f = value; return arg; }
+static inline LogArg log_arg(double value) { LogArg arg; arg.f = (float)value; return arg; }
+static inline LogArg log_arg(const char *value) { LogArg arg; arg.s = value; return arg; }
+
+template <typename... Args>
+static inline void log_emit(uint8_t level, uint16_t id, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "mensagem de log com argumentos demais");
+    LogArg list[] = { LogArg(), log_arg(args)... };
+    log_write(level, id, (uint8_t)sizeof...(Args), list + 1);
+}
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(id, ...) log_emit(LOG_LEVEL_DEBUG, id, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(id, ...) ((void)0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(id, ...) log_emit(LOG_LEVEL_INFO, id, ##__VA_ARGS__)
+#else
+#define LOG_INFO(id, ...) ((void)0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(id, ...) log_emit(LOG_LEVEL_WARN, id, ##__VA_ARGS__)
+#else
+#define LOG_WARN(id, ...) ((void)0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(id, ...) log_emit(LOG_LEVEL_ERROR, id, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(id, ...) ((void)0)
+#endif
+
+#endif // __cplusplus
+
+#endif // ASYNC_LOG_H
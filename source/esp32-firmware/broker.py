@@ -1,33 +1,717 @@
 import logging
+import os
 import socket
 import json
 import threading
-from flask import Flask, request, jsonify, send_from_directory, make_response
+import time
+import itertools
+import asyncio
+import codecs
+import ctypes
+import math
+import queue
+import struct
+import sys
+import zlib
+from array import array
+from collections import deque
+from flask import Flask, Response, request, jsonify, send_from_directory, make_response
 from flask_cors import CORS
 from datetime import datetime
 import sqlite3
-import os
 import cv2 
 
 logging.basicConfig(level=logging.INFO, format='[%(levelname)s] %(asctime)s - %(message)s')
 
-DB_NAME = 'planet_exploration.db'
-PHOTOS_DIR = 'C:/Users/naila/Documents/GitHub/autonomous-robot-esp32photos'
-DATA_PORT = 9998
-COMMAND_PORT = 9999
+DB_NAME = os.environ.get('BROKER_DB', 'planet_exploration.db')
+PHOTOS_DIR = os.environ.get('BROKER_PHOTOS_DIR', 'C:/Users/naila/Documents/GitHub/autonomous-robot-esp32photos')
+DATA_PORT = int(os.environ.get('BROKER_DATA_PORT', 9998))
+COMMAND_PORT = int(os.environ.get('BROKER_COMMAND_PORT', 9999))
 FLASK_PORT = 5001
+SUMMARY_CHANNELS = ('temp', 'hum', 'gas', 'lux')
+
+# Codec binário da telemetria (mesmas constantes de telemetry_codec.h e dos MAX_* do firmware)
+CODEC_FRAME_KEY = 0xF1
+CODEC_FRAME_DELTA = 0xF2
+CODEC_ADC_FULL_SCALE = 4095
+CODEC_LIFE_SCALE = 10000
+CODEC_FLAG_SYSTEM_ON = 0x01
+CODEC_FLAG_PREDICTED = 0x02
+CODEC_RATE_SHIFT = 4            # Bits 4-6 das flags: intervalo de amostragem = CODEC_RATE_UNIT_MS << (código - 1)
+CODEC_RATE_UNIT_MS = 125
+CODEC_FLAG_TRACE = 0x80         # Quadro termina com [varint envio][varint envio - captura]
+CODEC_CHANNEL_SCALES = (50.0, 100.0, 217.79, 1086.46)  # MAX_TEMPERATURE_C, umidade, MAX_GAS_PPM, MAX_LIGHT_CD
+CODEC_TERRAIN_STATUS = ("Desativado", "Ambiente Hostil ❌", "Condição Moderada 🟨", "Propício à vida ✅")
+
+# Comandos confirmados (ack) pelo ESP32
+COMMAND_ACK_TIMEOUT = 1.0       # s sem ack até retransmitir
+COMMAND_MAX_RETRIES = 3         # Retransmissões antes de dar o comando como falho
+COMMAND_WAIT_TIMEOUT = 5.0      # s até um comando concluir (ack, recusa ou desistência após os retries)
+COMMAND_HISTORY_SIZE = 256      # Comandos concluídos mantidos para consulta
+# Código HTTP de /commands/<id> por estado: aguardando, aplicado, recusado, sem confirmação
+COMMAND_STATUS_HTTP = {"pending": 202, "acked": 200, "rejected": 400, "failed": 504}
+LATENCY_BUCKETS_MS = (10, 25, 50, 100, 250, 500, 1000, 2500, 5000)
+LATENCY_WINDOW = 500            # Amostras recentes usadas nos percentis
+REVALIDATE = "no-cache"         # O navegador guarda a resposta mas sempre revalida (If-None-Match -> 304)
+
+# Laço de eventos dos dispositivos
+DEVICE_SHARDS = 16              # Partes da tabela de dispositivos, cada uma com sua trava
+DEVICE_BACKLOG = 1024           # Conexões TCP aguardando o accept
+DEVICE_IDLE_TIMEOUT = 300       # s sem receber nada até fechar a conexão
+DEVICE_WRITE_BUFFER_LIMIT = 16 * 1024  # Bytes pendentes no socket acima dos quais novos envios são recusados
+DEVICE_MAX_MESSAGE = 4096       # Maior mensagem JSON incompleta aceita de um dispositivo
+UDP_RECEIVE_BUFFER = 4 * 1024 * 1024   # Absorve rajadas da frota enquanto o laço está ocupado
+HOUSEKEEPING_INTERVAL = COMMAND_ACK_TIMEOUT / 4
+STORE_QUEUE_SIZE = 50000        # Linhas aguardando o SQLite; com a fila cheia a linha é descartada e contada
+STORE_BATCH_SIZE = 500          # Linhas por transação
+
+# Rastro de latência (captura no ESP32 -> desenho no dashboard)
+TIME_SYNC_INTERVAL = 10.0       # s entre trocas time_sync com cada dispositivo
+CLOCK_SYNC_WINDOW = 8           # Trocas mantidas; vale a de menor ida e volta
+CLOCK_RESET_MS = 2000           # Salto no deslocamento que indica ESP32 reiniciado (ou volta do millis)
+TRACE_HOPS = (
+    'device_queue',   # Captura -> envio no ESP32 (fila entre os núcleos + tarefa de rede)
+    'network',        # Envio -> recebimento no broker (precisa do relógio sincronizado)
+    'ingest',         # Recebimento -> última leitura publicada
+    'store',          # Recebimento -> commit no SQLite
+    'serve',          # Publicação -> primeira entrega ao dashboard
+    'render',         # Resposta no dashboard -> gráfico desenhado (informado pelo dashboard)
+    'end_to_end',     # Captura -> gráfico desenhado
+)
+TRACE_REPORT_MAX = 100          # Relatos de desenho aceitos por POST
+
+# Arquivo colunar: linhas antigas de sensor_data seladas em segmentos (formato em source/host/sensor_archive.h)
+ARCHIVE_DIR = os.environ.get('BROKER_ARCHIVE_DIR', 'archive')
+ARCHIVE_AFTER = float(os.environ.get('BROKER_ARCHIVE_AFTER', 24 * 3600))      # s até uma linha ser selada
+ARCHIVE_RETENTION = float(os.environ.get('BROKER_ARCHIVE_RETENTION', 0))      # s até apagar um segmento (0: nunca)
+ARCHIVE_INTERVAL = 600          # s entre verificações (com linhas pendentes, a próxima vem logo)
+ARCHIVE_BLOCK_ROWS = 4096       # Linhas por bloco (unidade do zone map e da compressão)
+ARCHIVE_SEGMENT_ROWS = 64 * ARCHIVE_BLOCK_ROWS   # Máximo por segmento; um segmento por verificação
+ARCHIVE_MAGIC = b'SNSCOL01'
+ARCHIVE_VERSION = 1
+ARCHIVE_HEADER = struct.Struct('<8sIIIIQqqqqQQII8x')   # ArchiveHeader, 96 bytes
+ARCHIVE_BLOCK = struct.Struct('<II')                   # ArchiveBlock: linhas + reservado
+ARCHIVE_CHUNK = struct.Struct('<QIBBHdd')              # ArchiveChunk, 32 bytes
+ARCHIVE_RAW, ARCHIVE_SHUFFLE_ZLIB, ARCHIVE_DELTA_SHUFFLE_ZLIB = 0, 1, 2
+# Colunas na ordem de sensor_archive.h: (tipo do array, largura, codificação comprimida)
+ARCHIVE_COLUMNS = (
+    ('q', 8, ARCHIVE_DELTA_SHUFFLE_ZLIB),   # Tempo (ms Unix): received_at, ou o timestamp do banco
+    ('H', 2, ARCHIVE_SHUFFLE_ZLIB),         # Dispositivo (índice na tabela de nomes do segmento)
+    ('f', 4, ARCHIVE_SHUFFLE_ZLIB),         # Temperatura
+    ('f', 4, ARCHIVE_SHUFFLE_ZLIB),         # Umidade
+    ('f', 4, ARCHIVE_SHUFFLE_ZLIB),         # Gás
+    ('f', 4, ARCHIVE_SHUFFLE_ZLIB),         # Luz
+    ('f', 4, ARCHIVE_SHUFFLE_ZLIB),         # Chance de vida
+)
+# Modelo no servidor: ia_model compilado como biblioteca compartilhada (source/ia_model/ia_model_lib.h)
+MODEL_LIBRARY = os.environ.get('BROKER_MODEL_LIB', os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                                '..', 'ia_model', 'libia_model.so'))
+MODEL_ABI_VERSION = 1           # IA_MODEL_ABI_VERSION
+MODEL_INPUT_SIZE = 4            # Temperatura, umidade, gás e luz, na ordem do modelo
+LIFE_THRESHOLDS = (0.5, 0.70)   # LIFE_THRESHOLD_MODERATE e LIFE_THRESHOLD_FAVORABLE
+
+SQL_SELECT_ARCHIVE = '''
+    SELECT id, device_name, CAST(COALESCE(received_at, strftime('%s', timestamp)) * 1000 AS INTEGER),
+           temperature, humidity, gas, light, life_probability
+    FROM sensor_data WHERE id > ? AND id <= ? ORDER BY id LIMIT ?
+'''
+
+SQL_INSERT_SENSOR_DATA = '''
+    INSERT INTO sensor_data (device_name, temperature, humidity, gas, light, life_probability, terrain_status, photo_url,
+                             captured_at, received_at, server_life_probability)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+'''
+SQL_INSERT_SENSOR_SUMMARY = f'''
+    INSERT INTO sensor_summary (
+        device_name, window_ms, sample_count,
+        temperature_min, temperature_max, temperature_mean, temperature_var, temperature_last,
+        humidity_min, humidity_max, humidity_mean, humidity_var, humidity_last,
+        gas_min, gas_max, gas_mean, gas_var, gas_last,
+        light_min, light_max, light_mean, light_var, light_last,
+        life_probability_max, life_probability_mean, life_probability_last, terrain_status,
+        captured_at, received_at, server_life_probability_last
+    )
+    VALUES ({', '.join('?' * 30)})
+'''
+# Instruções pontuadas no servidor: (índices das leituras, índice da chance de vida do dispositivo) na
+# tupla de valores; a chance do servidor é acrescentada como último parâmetro
+SCORED_INSERTS = {
+    SQL_INSERT_SENSOR_DATA: ((1, 2, 3, 4), 5),
+    SQL_INSERT_SENSOR_SUMMARY: ((7, 12, 17, 22), 25),   # Últimas leituras da janela e life_chance.last
+}
+SQL_UPDATE_PHOTO = '''
+    UPDATE sensor_data
+    SET photo_url = ?
+    WHERE id = (
+        SELECT id FROM sensor_data
+        WHERE device_name = ?
+        ORDER BY timestamp DESC
+        LIMIT 1
+    )
+'''
+
+
+class CodecDecoder:
+    """Decodificador de quadros delta + varint de um único remetente (ver telemetry_codec.h)."""
+
+    def __init__(self):
+        self.name = None
+        self.seq = 0
+        self.synced = False
+        self.previous = [0] * (len(CODEC_CHANNEL_SCALES) + 1)
+        self.previous_send_ms = 0
+        self.last_seen_ms = 0.0   # monotonic_ms() do último quadro, para descartar remetentes ociosos
+
+    @staticmethod
+    def read_varint(frame, pos):
+        value = shift = 0
+        while True:
+            byte = frame[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                return value, pos
+            shift += 7
+            if shift > 28:
+                raise ValueError("varint longo demais")
+
+    def decode(self, frame):
+        """Retorna a mensagem no formato JSON de 'sensor_data', ou None se o quadro foi descartado."""
+        frame_type, seq, pos = frame[0], frame[1], 2
+        if frame_type == CODEC_FRAME_KEY:
+            name_length = frame[pos]
+            self.name = frame[pos + 1:pos + 1 + name_length].decode()
+            pos += 1 + name_length
+        elif not self.synced or seq != (self.seq + 1) & 0xFF:
+            # Perda de quadro: os deltas só voltam a valer depois do próximo quadro chave
+            self.synced = False
+            return None
+
+        flags = frame[pos]
+        pos += 1
+        values = []
+        for previous in self.previous:
+            word, pos = self.read_varint(frame, pos)
+            if frame_type == CODEC_FRAME_KEY:
+                values.append(word)
+            else:
+                values.append(previous + ((word >> 1) ^ -(word & 1)))
+        trace = None
+        if flags & CODEC_FLAG_TRACE:
+            send_word, pos = self.read_varint(frame, pos)
+            age, pos = self.read_varint(frame, pos)
+            send_ms = send_word if frame_type == CODEC_FRAME_KEY else (self.previous_send_ms + send_word) & 0xFFFFFFFF
+            self.previous_send_ms = send_ms
+            trace = {"seq": seq, "send_ms": send_ms, "capture_ms": (send_ms - age) & 0xFFFFFFFF}
+        self.previous = values
+        self.seq = seq
+        self.synced = True
+
+        data = {channel: round(code / CODEC_ADC_FULL_SCALE * scale, 2)
+                for channel, code, scale in zip(SUMMARY_CHANNELS, values, CODEC_CHANNEL_SCALES)}
+        data['life_chance'] = values[-1] / CODEC_LIFE_SCALE
+        data['terrain_status'] = CODEC_TERRAIN_STATUS[(flags >> 2) & 0x03]
+        data['system_on'] = bool(flags & CODEC_FLAG_SYSTEM_ON)
+        data['predicted'] = bool(flags & CODEC_FLAG_PREDICTED)
+        rate_code = (flags >> CODEC_RATE_SHIFT) & 0x07
+        if rate_code:
+            data['interval_ms'] = CODEC_RATE_UNIT_MS << (rate_code - 1)
+        message = {"source": self.name, "type": "sensor_data", "data": data}
+        if trace:
+            message['trace'] = trace
+        return message
+
+class LatencyHistogram:
+    """Histograma de latências em ms (buckets fixos) com janela recente para os percentis."""
+
+    def __init__(self):
+        self.counts = [0] * (len(LATENCY_BUCKETS_MS) + 1)  # Último bucket: acima do maior limite
+        self.recent = deque(maxlen=LATENCY_WINDOW)
+        self.total = 0
+        self.max_ms = 0.0
+
+    def add(self, value_ms):
+        index = len(LATENCY_BUCKETS_MS)
+        for i, limit in enumerate(LATENCY_BUCKETS_MS):
+            if value_ms <= limit:
+                index = i
+                break
+        self.counts[index] += 1
+        self.recent.append(value_ms)
+        self.total += 1
+        self.max_ms = max(self.max_ms, value_ms)
+
+    def percentile(self, ordered, p):
+        if not ordered:
+            return None
+        return round(ordered[min(len(ordered) - 1, int(p / 100.0 * len(ordered)))], 2)
+
+    def to_dict(self):
+        ordered = sorted(self.recent)
+        buckets = {f"<={limit}": count for limit, count in zip(LATENCY_BUCKETS_MS, self.counts)}
+        buckets[f">{LATENCY_BUCKETS_MS[-1]}"] = self.counts[-1]
+        return {
+            "count": self.total,
+            "max_ms": round(self.max_ms, 2),
+            "p50_ms": self.percentile(ordered, 50),
+            "p95_ms": self.percentile(ordered, 95),
+            "p99_ms": self.percentile(ordered, 99),
+            "buckets": buckets,
+        }
+
+class PendingCommand:
+    """Comando enviado ao ESP32 aguardando o ack."""
+
+    def __init__(self, command_id, device_name, payload):
+        self.id = command_id
+        self.device_name = device_name
+        self.payload = payload
+        self.first_sent = None
+        self.last_sent = None
+        self.attempts = 0
+        self.status = "pending"    # pending, acked, rejected (nack do dispositivo), failed
+        self.result = None
+        self.done = threading.Event()
+
+    def to_dict(self):
+        info = {"id": self.id, "device": self.device_name, "status": self.status, "attempts": self.attempts}
+        if self.result:
+            info.update(self.result)
+        return info
+
+def monotonic_ms():
+    return time.monotonic() * 1000.0
+
+def wall_time(monotonic):
+    """Instante do relógio monotônico (ms) em segundos Unix, para gravar e mostrar."""
+    return time.time() - (monotonic_ms() - monotonic) / 1000.0
+
+class ClockSync:
+    """Deslocamento entre o millis() de um ESP32 e o relógio monotônico do broker, como no NTP:
+    offset = device_ms - (envio + resposta) / 2 da troca time_sync com menor ida e volta entre as
+    últimas CLOCK_SYNC_WINDOW. O erro fica dentro de metade dessa ida e volta."""
+
+    def __init__(self):
+        self.samples = deque(maxlen=CLOCK_SYNC_WINDOW)
+        self.offset_ms = None
+        self.rtt_ms = None
+        self.exchanges = 0
+
+    def add(self, sent_ms, replied_ms, device_ms):
+        rtt = replied_ms - sent_ms
+        offset = device_ms - (sent_ms + replied_ms) / 2.0
+        if self.offset_ms is not None and abs(offset - self.offset_ms) > CLOCK_RESET_MS + rtt:
+            self.samples.clear()
+        self.samples.append((rtt, offset))
+        self.rtt_ms, self.offset_ms = min(self.samples)
+        self.exchanges += 1
+
+    def to_broker(self, device_ms):
+        return None if self.offset_ms is None else device_ms - self.offset_ms
+
+    def to_dict(self):
+        return {"synced": self.offset_ms is not None, "exchanges": self.exchanges,
+                "offset_ms": None if self.offset_ms is None else round(self.offset_ms, 1),
+                "error_ms": None if self.rtt_ms is None else round(self.rtt_ms / 2.0, 1)}
+
+class TraceStats:
+    """Histogramas de latência por etapa, somando a frota inteira."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.hops = {hop: LatencyHistogram() for hop in TRACE_HOPS}
+
+    def record(self, hop, value_ms):
+        with self.lock:
+            self.hops[hop].add(max(0.0, value_ms))
+
+    def to_dict(self):
+        with self.lock:
+            return {hop: histogram.to_dict() for hop, histogram in self.hops.items()}
+
+class SampleTrace:
+    """Instantes de uma amostra no relógio monotônico do broker (ms). Captura e envio só são
+    conhecidos depois que o relógio do dispositivo foi sincronizado."""
+
+    __slots__ = ('stats', 'seq', 'capture', 'send', 'received', 'published', 'committed', 'served')
+
+    def __init__(self, stats, received, device_trace, clock):
+        self.stats = stats
+        self.received = received
+        self.published = self.committed = self.served = None
+        device_trace = device_trace or {}
+        self.seq = device_trace.get('seq')
+        self.capture = self.send = None
+        capture_ms, send_ms = device_trace.get('capture_ms'), device_trace.get('send_ms')
+        if capture_ms is None or send_ms is None:
+            return
+        stats.record('device_queue', (send_ms - capture_ms) & 0xFFFFFFFF)
+        self.capture, self.send = clock.to_broker(capture_ms), clock.to_broker(send_ms)
+        if self.send is not None:
+            stats.record('network', received - self.send)
+
+    def origin(self):
+        return self.capture if self.capture is not None else self.received
+
+    def serve(self, now):
+        """Chamado a cada entrega; a primeira mede a etapa 'serve'. Retorna a idade da amostra."""
+        if self.served is None:
+            self.served = now
+            self.stats.record('serve', now - self.published)
+        return now - self.origin()
+
+    def to_dict(self):
+        return {"seq": self.seq, "captured_at": None if self.capture is None else round(wall_time(self.capture), 3),
+                "received_at": round(wall_time(self.received), 3)}
+
+class CachedResponse:
+    """Corpo JSON já serializado e seu ETag. Imutável: quem publica troca o objeto inteiro, então os
+    leitores das rotas pegam a referência sem trava e nunca veem um corpo pela metade."""
+
+    def __init__(self, payload, tag, version, status=200, trace=None):
+        self.body = json.dumps(payload).encode()
+        self.etag = f'"{tag}-{version}"'
+        self.version = version
+        self.status = status
+        self.trace = trace
+
+    def respond(self):
+        if_none_match = request.headers.get("If-None-Match", "")
+        if self.status == 200 and (if_none_match.strip() == "*" or self.etag in (t.strip() for t in if_none_match.split(","))):
+            response = Response(status=304)
+        else:
+            response = Response(self.body, status=self.status, mimetype="application/json")
+        response.headers["ETag"] = self.etag
+        response.headers["Cache-Control"] = REVALIDATE
+        if self.trace:
+            # Idade da amostra nesta entrega (desde a captura, ou desde o recebimento sem relógio sincronizado)
+            response.headers["X-Sample-Age-Ms"] = f"{self.trace.serve(monotonic_ms()):.1f}"
+        return response
+
+class DeviceSession:
+    """Conexão TCP de comandos de um dispositivo. O transporte só é usado no laço de eventos;
+    as outras threads enviam por Broker.queue_send."""
+
+    def __init__(self, writer):
+        self.writer = writer
+        self.address = writer.get_extra_info('peername')
+        self.name = None
+        self.closed = False
+        self.last_activity = time.monotonic()
+        self.time_sync = None          # (id, enviado em ms) da troca time_sync em andamento
+        self.next_time_sync = 0.0
+
+    def buffered(self):
+        return self.writer.transport.get_write_buffer_size()
+
+class DeviceState:
+    """Estado de um dispositivo (por nome), mantido entre reconexões."""
+
+    def __init__(self, name):
+        self.name = name
+        self.session = None            # DeviceSession atual (None = offline)
+        self.latest = None             # Último dado recebido
+        self.latest_response = None    # CachedResponse do último dado
+        self.round_trip = LatencyHistogram()     # Envio até ack no broker
+        self.device_apply = LatencyHistogram()   # Recebido até aplicado no ESP32
+        self.clock = ClockSync()
+        self.last_trace = None
+
+class DeviceShard:
+    """Parte da tabela de dispositivos com a própria trava: threads que mexem em dispositivos
+    diferentes raramente disputam a mesma trava."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.devices = {}
+
+class NativeScorer:
+    """Pontua no servidor, com o modelo em C (libia_model.so via ctypes), as leituras que chegam dos
+    robôs: um lote inteiro de linhas por chamada, em float32 contíguo, sem passar linha a linha pelo
+    Python. Sem a biblioteca (ou com outra ABI) o broker segue gravando só a chance do dispositivo."""
+
+    def __init__(self, path):
+        self.path = path
+        self.library = None
+        self.fingerprint = None
+        self.calls = self.rows = 0
+        self.native_s = 0.0
+        try:
+            library = ctypes.CDLL(path)
+            library.ia_model_abi_version.restype = ctypes.c_uint32
+            library.ia_model_input_size.restype = ctypes.c_uint32
+            library.ia_model_fingerprint.restype = ctypes.c_uint32
+            library.ia_model_score_batch.argtypes = (ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t)
+            library.ia_model_score_batch.restype = ctypes.c_int
+        except (OSError, AttributeError) as e:
+            logging.warning(f"Modelo do servidor desativado: '{path}' não carregou ({e}).")
+            return
+        if library.ia_model_abi_version() != MODEL_ABI_VERSION or library.ia_model_input_size() != MODEL_INPUT_SIZE:
+            logging.warning(f"Modelo do servidor desativado: ABI {library.ia_model_abi_version()} em '{path}', "
+                            f"esperada {MODEL_ABI_VERSION}.")
+            return
+        self.library = library
+        self.fingerprint = format(library.ia_model_fingerprint(), "08x")
+        logging.info(f"Modelo do servidor: '{path}' (pesos {self.fingerprint}).")
+
+    @staticmethod
+    def pack(rows, inputs):
+        """Leituras das linhas em um array float32 (MODEL_INPUT_SIZE por linha); ausente vira NaN."""
+        try:
+            return array('f', [values[i] for values in rows for i in inputs])
+        except TypeError:
+            # Algum valor None (canal ausente no resumo) ou não numérico: caminho lento só neste lote
+            return array('f', [values[i] if isinstance(values[i], (int, float)) else math.nan
+                               for values in rows for i in inputs])
+
+    def score(self, readings):
+        """Chances de vida (array float32, NaN onde faltou leitura) para as leituras empacotadas."""
+        count = len(readings) // MODEL_INPUT_SIZE
+        scores = array('f', bytes(4 * count))
+        if count:
+            start = time.perf_counter()
+            # buffer_info(): endereço dos próprios arrays, a biblioteca lê e escreve sem cópia
+            self.library.ia_model_score_batch(readings.buffer_info()[0], scores.buffer_info()[0], count)
+            self.native_s += time.perf_counter() - start
+            self.calls += 1
+            self.rows += count
+        return scores
+
+    def to_dict(self):
+        return {"library": os.path.abspath(self.path), "loaded": self.library is not None,
+                "abi_version": MODEL_ABI_VERSION, "fingerprint": self.fingerprint, "calls": self.calls,
+                "rows": self.rows, "ns_per_row": round(1e9 * self.native_s / self.rows, 1) if self.rows else None}
+
+class ModelAgreement:
+    """Concordância entre a chance de vida do dispositivo e a do servidor, por dispositivo. Uma
+    divergência persistente indica robô com pesos antigos (ou leituras alteradas no caminho).
+    Só entram as linhas em que o robô previu sobre a própria leitura ('predicted'); nos outros
+    ciclos ele manda life_chance 0, que não diz nada sobre o modelo dele."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.devices = {}   # nome -> [linhas comparadas, soma |diferença|, máx |diferença|, classes diferentes]
+
+    def record(self, rows, scores, device_index, compare):
+        moderate, favorable = LIFE_THRESHOLDS
+        with self.lock:
+            for values, server, predicted in zip(rows, scores, compare):
+                if not predicted:
+                    continue
+                device = values[device_index]
+                # NaN != NaN: descarta leitura ausente dos dois lados
+                if not isinstance(device, (int, float)) or device != device or server != server:
+                    continue
+                diff = abs(device - server)
+                entry = self.devices.get(values[0])
+                if entry is None:
+                    entry = self.devices[values[0]] = [0, 0.0, 0.0, 0]
+                entry[0] += 1
+                entry[1] += diff
+                if diff > entry[2]:
+                    entry[2] = diff
+                if (device >= moderate) + (device >= favorable) != (server >= moderate) + (server >= favorable):
+                    entry[3] += 1
+
+    def to_dict(self):
+        with self.lock:
+            return {name: {"rows": rows, "mean_abs_diff": round(total / rows, 6), "max_abs_diff": round(worst, 6),
+                           "class_mismatches": mismatches}
+                    for name, (rows, total, worst, mismatches) in self.devices.items()}
+
+class ColumnarArchive:
+    """Segmentos imutáveis com as linhas antigas de sensor_data, um arquivo por faixa de ids
+    (sensor_data_<primeiro id>-<último id>.col). Cada bloco guarda as colunas com largura fixa,
+    comprimidas (bytes agrupados + zlib) e com mínimo/máximo no diretório, para o leitor em C
+    (source/host/sensor_archive.c) mapear o arquivo e pular os blocos fora da consulta.
+    Só a thread de gravação sela e apaga; as rotas apenas leem os cabeçalhos."""
+
+    def __init__(self, directory):
+        self.directory = directory
+        os.makedirs(directory, exist_ok=True)
+        self.last_id = max((last for _, _, last in self.segment_files()), default=0)
+
+    def segment_files(self):
+        """(caminho, primeiro id, último id) de cada segmento, em ordem de ids."""
+        segments = []
+        for name in os.listdir(self.directory):
+            if name.startswith('sensor_data_') and name.endswith('.col'):
+                first, _, last = name[len('sensor_data_'):-len('.col')].partition('-')
+                if first.isdigit() and last.isdigit():
+                    segments.append((os.path.join(self.directory, name), int(first), int(last)))
+        return sorted(segments, key=lambda segment: segment[1])
+
+    @staticmethod
+    def read_header(path):
+        with open(path, 'rb') as f:
+            fields = ARCHIVE_HEADER.unpack(f.read(ARCHIVE_HEADER.size))
+        if fields[0] != ARCHIVE_MAGIC:
+            raise ValueError(f"{path}: não é um segmento do arquivo colunar")
+        keys = ('magic', 'version', 'columns', 'block_rows', 'blocks', 'rows', 'first_id', 'last_id',
+                'min_time_ms', 'max_time_ms', 'directory_offset', 'names_offset', 'names_count')
+        return dict(zip(keys, fields))
+
+    def segments(self):
+        result = []
+        for path, _, _ in self.segment_files():
+            try:
+                header = self.read_header(path)
+                size = os.path.getsize(path)
+            except (OSError, ValueError, struct.error):
+                continue    # Apagado pela retenção no meio da listagem
+            result.append({"file": os.path.basename(path), "rows": header['rows'], "blocks": header['blocks'],
+                           "first_id": header['first_id'], "last_id": header['last_id'],
+                           "from": header['min_time_ms'] / 1000.0, "to": header['max_time_ms'] / 1000.0,
+                           "devices": header['names_count'], "bytes": size})
+        return result
+
+    @staticmethod
+    def little_endian(values):
+        if sys.byteorder != 'little':
+            values = array(values.typecode, values)
+            values.byteswap()
+        return values.tobytes()
+
+    def encode_chunk(self, values, width, encoding):
+        """(bytes, codificação, mínimo, máximo) de uma coluna de um bloco."""
+        present = [v for v in values if v == v]    # NaN (NULL no banco) fica fora do zone map
+        low, high = (float(min(present)), float(max(present))) if present else (float('nan'), float('nan'))
+        raw = self.little_endian(values)
+        data = raw
+        if encoding == ARCHIVE_DELTA_SHUFFLE_ZLIB:
+            data = self.little_endian(array(values.typecode, [values[0]] + [b - a for a, b in zip(values, values[1:])]))
+        # Agrupa o byte k de todos os valores: expoentes e bytes altos parecidos ficam juntos para o zlib
+        packed = zlib.compress(b''.join(data[k::width] for k in range(width)), 6)
+        if len(packed) < len(raw):
+            return packed, encoding, low, high
+        return raw, ARCHIVE_RAW, low, high
+
+    def write_segment(self, rows):
+        """Grava as linhas (id, dispositivo, tempo ms, 5 canais) num segmento novo e retorna o caminho."""
+        names = {}
+        columns = [array(typecode) for typecode, _, _ in ARCHIVE_COLUMNS]
+        nan = float('nan')
+        for _, device_name, time_ms, *channels in rows:
+            columns[0].append(int(time_ms or 0))
+            columns[1].append(names.setdefault(device_name, len(names)))
+            for column, value in zip(columns[2:], channels):
+                column.append(nan if value is None else value)
+        first_id, last_id = rows[0][0], rows[-1][0]
+        path = os.path.join(self.directory, f"sensor_data_{first_id:012d}-{last_id:012d}.col")
+        temporary = path + '.tmp'
+        directory = []
+        with open(temporary, 'wb') as f:
+            f.write(bytes(ARCHIVE_HEADER.size))
+            for start in range(0, len(rows), ARCHIVE_BLOCK_ROWS):
+                block = [ARCHIVE_BLOCK.pack(min(ARCHIVE_BLOCK_ROWS, len(rows) - start), 0)]
+                for values, (_, width, encoding) in zip(columns, ARCHIVE_COLUMNS):
+                    data, used, low, high = self.encode_chunk(values[start:start + ARCHIVE_BLOCK_ROWS], width, encoding)
+                    offset = f.tell()
+                    f.write(data + bytes(-len(data) % 8))   # Pedaços alinhados: os não comprimidos são lidos no lugar
+                    block.append(ARCHIVE_CHUNK.pack(offset, len(data), used, width, 0, low, high))
+                directory.append(b''.join(block))
+            names_offset = f.tell()
+            table = b''.join(bytes([len(encoded)]) + encoded
+                             for encoded in (name.encode()[:255] for name in names))
+            f.write(table + bytes(-len(table) % 8))
+            directory_offset = f.tell()
+            f.write(b''.join(directory))
+            f.seek(0)
+            f.write(ARCHIVE_HEADER.pack(ARCHIVE_MAGIC, ARCHIVE_VERSION, len(ARCHIVE_COLUMNS), ARCHIVE_BLOCK_ROWS,
+                                        len(directory), len(rows), first_id, last_id, min(columns[0]), max(columns[0]),
+                                        directory_offset, names_offset, len(names), 0))
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(temporary, path)
+        return path
+
+    def seal(self, conn):
+        """Sela um segmento com as linhas mais antigas que ARCHIVE_AFTER e as apaga da tabela.
+        Retorna o número de linhas seladas (0: nada pendente)."""
+        stored = conn.execute("SELECT last_id FROM archive_state WHERE id = 1").fetchone()
+        self.last_id = max(self.last_id, stored[0] if stored else 0)
+        # Segmento gravado mas linhas não apagadas (queda entre os dois passos): termina a limpeza
+        conn.execute("DELETE FROM sensor_data WHERE id <= ? AND photo_url IS NULL", (self.last_id,))
+        limit_id = conn.execute("SELECT MAX(id) FROM sensor_data WHERE id > ? AND timestamp < datetime('now', ?)",
+                                (self.last_id, f"-{int(ARCHIVE_AFTER)} seconds")).fetchone()[0]
+        if limit_id is None:
+            conn.commit()
+            return 0
+        # Por faixa de ids (não por tempo): toda linha da faixa entra no segmento antes de ser apagada
+        rows = conn.execute(SQL_SELECT_ARCHIVE, (self.last_id, limit_id, ARCHIVE_SEGMENT_ROWS)).fetchall()
+        if len({row[1] for row in rows}) > 65536:
+            raise ValueError("mais de 65536 dispositivos num segmento")
+        path = self.write_segment(rows)
+        self.last_id = rows[-1][0]
+        # Linhas com foto ficam na tabela: o vínculo com a foto (e /photos/latest após reiniciar) continua no banco
+        conn.execute("DELETE FROM sensor_data WHERE id BETWEEN ? AND ? AND photo_url IS NULL", (rows[0][0], self.last_id))
+        conn.execute("INSERT OR REPLACE INTO archive_state (id, last_id) VALUES (1, ?)", (self.last_id,))
+        conn.commit()
+        logging.info(f"{len(rows)} linhas de sensor_data seladas em '{path}'.")
+        return len(rows)
+
+    def apply_retention(self):
+        """Retenção: apaga os segmentos cujo dado mais novo passou de ARCHIVE_RETENTION."""
+        if ARCHIVE_RETENTION <= 0:
+            return 0
+        oldest = (time.time() - ARCHIVE_RETENTION) * 1000.0
+        removed = 0
+        for path, _, _ in self.segment_files():
+            try:
+                if self.read_header(path)['max_time_ms'] < oldest:
+                    os.remove(path)
+                    removed += 1
+            except (OSError, ValueError, struct.error) as e:
+                logging.warning(f"Segmento '{path}' ignorado na retenção: {e}")
+        return removed
+
+class DataProtocol(asyncio.DatagramProtocol):
+    def __init__(self, broker):
+        self.broker = broker
+
+    def datagram_received(self, data, sender_address):
+        self.broker.process_data(data, sender_address)
 
 class Broker:
+    """Lado dos dispositivos num laço asyncio (uma thread): todos os sockets TCP de comando e o
+    socket UDP de dados são multiplexados nele, sem uma thread por dispositivo. O SQLite fica numa
+    thread própria, alimentada por uma fila limitada, e o Flask só lê respostas já prontas."""
+
     def __init__(self, data_port, command_port):
         self.ipHost = '0.0.0.0'
         self.data_port = data_port
         self.command_port = command_port
-        self.devices = {}   
-        self.datas = {}     
-        self.lock = threading.Lock()
+        self.shards = [DeviceShard() for _ in range(DEVICE_SHARDS)]
+        self.codec_decoders = {}  # Decodificador por endereço UDP de origem (só o laço usa; ociosos saem no housekeeping)
+        self.sessions = set()     # Conexões abertas (só o laço usa)
+        self.command_ids = itertools.count(1)
+        self.commands_lock = threading.Lock()
+        self.pending_commands = {}         # id -> PendingCommand ainda sem ack
+        self.finished_commands = deque(maxlen=COMMAND_HISTORY_SIZE)
+        # Respostas prontas das rotas de leitura, refeitas só na ingestão (ETag = início do broker + versão)
+        # Época do broker: vai nos comandos para o ESP32 saber quando a numeração recomeçou
+        self.boot_epoch = int(time.time())
+        self.boot_tag = format(self.boot_epoch, "x")
+        self.versions = itertools.count(1)
+        self.registry_lock = threading.Lock()
+        self.device_names = []             # Dispositivos que já enviaram dados, para /devices
+        self.devices_response = CachedResponse([], self.boot_tag, 0)
+        self.photo_response = None
+        self.store_queue = queue.Queue(maxsize=STORE_QUEUE_SIZE)
+        self.counters = dict.fromkeys(('udp_datagrams', 'udp_invalid', 'stored', 'store_dropped',
+                                       'writes_rejected', 'connections', 'archived', 'server_scored'), 0)
+        self.loop_lag_ms = 0.0
+        self.trace_stats = TraceStats()
+        self.scorer = NativeScorer(MODEL_LIBRARY)
+        self.model_agreement = ModelAgreement()
         self.init_database()
-        self.setup_data_server()
-        self.setup_command_server()
+        self.archive = ColumnarArchive(ARCHIVE_DIR)
+        threading.Thread(target=self.storage_writer, daemon=True).start()
+        self.loop = asyncio.new_event_loop()
+        ready = threading.Event()
+        self.loop_thread = threading.Thread(target=self.run_event_loop, args=(ready,), daemon=True)
+        self.loop_thread.start()
+        ready.wait()
 
     def init_database(self):
         conn = sqlite3.connect(DB_NAME, check_same_thread=False)
@@ -43,106 +727,499 @@ class Broker:
                 light REAL,
                 life_probability REAL,
                 terrain_status TEXT,
-                photo_url TEXT DEFAULT NULL
+                photo_url TEXT DEFAULT NULL,
+                captured_at REAL,       -- Captura no ADC (Unix, s), com o relógio do dispositivo sincronizado
+                received_at REAL,       -- Chegada do datagrama ao broker (Unix, s)
+                server_life_probability REAL    -- Mesma leitura pontuada no broker (NULL sem libia_model)
+            )
+        ''')
+        cursor.execute('''
+            CREATE TABLE IF NOT EXISTS sensor_summary (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                device_name TEXT NOT NULL,
+                timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,
+                window_ms INTEGER,
+                sample_count INTEGER,
+                temperature_min REAL, temperature_max REAL, temperature_mean REAL, temperature_var REAL, temperature_last REAL,
+                humidity_min REAL, humidity_max REAL, humidity_mean REAL, humidity_var REAL, humidity_last REAL,
+                gas_min REAL, gas_max REAL, gas_mean REAL, gas_var REAL, gas_last REAL,
+                light_min REAL, light_max REAL, light_mean REAL, light_var REAL, light_last REAL,
+                life_probability_max REAL,
+                life_probability_mean REAL,
+                life_probability_last REAL,
+                terrain_status TEXT,
+                captured_at REAL,
+                received_at REAL,
+                server_life_probability_last REAL
+            )
+        ''')
+        # Último id selado no arquivo colunar (os segmentos podem ter sido apagados pela retenção)
+        cursor.execute('''
+            CREATE TABLE IF NOT EXISTS archive_state (
+                id INTEGER PRIMARY KEY CHECK (id = 1),
+                last_id INTEGER NOT NULL
             )
         ''')
+        # Bancos anteriores ao rastro de latência e ao modelo no servidor: acrescenta as colunas novas
+        added = {'sensor_data': ('captured_at', 'received_at', 'server_life_probability'),
+                 'sensor_summary': ('captured_at', 'received_at', 'server_life_probability_last')}
+        for table, new_columns in added.items():
+            columns = {row[1] for row in cursor.execute(f"PRAGMA table_info({table})")}
+            for column in new_columns:
+                if column not in columns:
+                    cursor.execute(f"ALTER TABLE {table} ADD COLUMN {column} REAL")
         conn.commit()
+        cursor.execute("SELECT photo_url FROM sensor_data WHERE photo_url IS NOT NULL ORDER BY timestamp DESC LIMIT 1")
+        result = cursor.fetchone()
         conn.close()
+        self.publish_photo(result[0] if result else None)
         logging.info(f"Banco de dados SQLite '{DB_NAME}' inicializado.")
         os.makedirs(PHOTOS_DIR, exist_ok=True)
         logging.info(f"Diretório de fotos '{PHOTOS_DIR}' verificado/criado.")
 
-    def store_sensor_data(self, device_name, data, photo_url=None):
+    # --- Gravação no SQLite (thread própria) ---
+
+    def enqueue_store(self, sql, values, trace=None, score=None):
+        """Chamado no laço: nunca espera pelo disco. Com a fila cheia a linha é descartada e contada.
+        score (só nas instruções de SCORED_INSERTS): None não pontua no servidor (sistema desligado,
+        leituras zeradas), False pontua e True pontua e compara com a chance do dispositivo."""
         try:
-            conn = sqlite3.connect(DB_NAME, check_same_thread=False)
-            cursor = conn.cursor()
-            cursor.execute('''
-                INSERT INTO sensor_data (device_name, temperature, humidity, gas, light, life_probability, terrain_status, photo_url)
-                VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-            ''', (
-                device_name,
-                data.get('temp'),
-                data.get('hum'),
-                data.get('gas'),
-                data.get('lux'),
-                data.get('life_chance'),
-                data.get('terrain_status'),
-                photo_url 
-            ))
-            conn.commit()
-            conn.close()
+            self.store_queue.put_nowait((sql, values, trace, score))
+        except queue.Full:
+            self.counters['store_dropped'] += 1
+            if self.counters['store_dropped'] % 1000 == 1:
+                logging.warning(f"Fila do banco cheia: {self.counters['store_dropped']} linhas descartadas até agora.")
+
+    def storage_writer(self):
+        """Grava as linhas da fila em lotes: uma transação e um executemany por sequência de mesma instrução."""
+        conn = sqlite3.connect(DB_NAME, check_same_thread=False)
+        next_archive = 0.0
+        while True:
+            if time.monotonic() >= next_archive:
+                next_archive = time.monotonic() + self.maintain_archive(conn)
+            try:
+                batch = [self.store_queue.get(timeout=ARCHIVE_INTERVAL)]
+            except queue.Empty:
+                continue
+            while len(batch) < STORE_BATCH_SIZE:
+                try:
+                    batch.append(self.store_queue.get_nowait())
+                except queue.Empty:
+                    break
+            try:
+                for sql, group in itertools.groupby(batch, key=lambda item: item[0]):
+                    group = list(group)
+                    rows = [values for _, values, _, _ in group]
+                    if sql in SCORED_INSERTS:
+                        rows = self.score_rows(sql, rows, [score for _, _, _, score in group])
+                    cursor = conn.executemany(sql, rows)
+                    if sql is SQL_UPDATE_PHOTO and cursor.rowcount == 0:
+                        logging.warning("Não foi encontrado registro para atualizar com a foto.")
+                conn.commit()
+                self.counters['stored'] += len(batch)
+                committed = monotonic_ms()
+                for _, _, trace, _ in batch:
+                    if trace:
+                        trace.committed = committed
+                        self.trace_stats.record('store', committed - trace.received)
+            except Exception as e:
+                logging.error(f"Erro ao armazenar dados no banco de dados: {e}")
+
+    def score_rows(self, sql, rows, modes):
+        """Acrescenta a chance de vida do servidor às linhas: uma chamada nativa por grupo do lote.
+        modes: o 'score' de enqueue_store de cada linha; linhas com None ficam sem chance do servidor."""
+        scored = [i for i, mode in enumerate(modes) if mode is not None]
+        if self.scorer.library is None or not scored:
+            return [(*values, None) for values in rows]
+        inputs, device_index = SCORED_INSERTS[sql]
+        subset = rows if len(scored) == len(rows) else [rows[i] for i in scored]
+        try:
+            scores = self.scorer.score(self.scorer.pack(subset, inputs))
+        except Exception as e:
+            logging.error(f"Erro ao pontuar o lote no servidor: {e}")
+            return [(*values, None) for values in rows]
+        self.counters['server_scored'] += len(subset)
+        self.model_agreement.record(subset, scores, device_index, [modes[i] for i in scored])
+        server = [None] * len(rows)
+        for i, score in zip(scored, scores):
+            server[i] = None if math.isnan(score) else score
+        return [(*values, score) for values, score in zip(rows, server)]
+
+    def maintain_archive(self, conn):
+        """Entre dois lotes: sela um segmento e aplica a retenção. Retorna em quantos segundos repetir;
+        com mais linhas pendentes, logo, para não segurar a fila de gravação por muito tempo."""
+        try:
+            sealed = self.archive.seal(conn)
+            self.counters['archived'] += sealed
+            removed = self.archive.apply_retention()
+            if removed:
+                logging.info(f"Retenção: {removed} segmento(s) do arquivo colunar apagado(s).")
+            return 1.0 if sealed == ARCHIVE_SEGMENT_ROWS else ARCHIVE_INTERVAL
         except Exception as e:
-            logging.error(f"Erro ao armazenar dados no banco de dados: {e}")
+            conn.rollback()
+            logging.error(f"Erro ao selar o arquivo colunar: {e}")
+            return ARCHIVE_INTERVAL
+
+    @staticmethod
+    def trace_times(trace):
+        """captured_at e received_at (segundos Unix) das colunas do banco."""
+        if not trace:
+            return [None, None]
+        return [None if trace.capture is None else wall_time(trace.capture), wall_time(trace.received)]
+
+    @staticmethod
+    def score_mode(data, predictions=1):
+        """Sistema desligado: sem pontuar (leituras zeradas). Compara com o dispositivo só se ele previu
+        nesta leitura; firmware sem o campo 'predicted' manda 0 nos ciclos sem predição."""
+        if data.get('system_on') is False:
+            return None
+        return data.get('predicted') is True and bool(predictions)
+
+    def store_sensor_data(self, device_name, data, photo_url=None, trace=None):
+        self.enqueue_store(SQL_INSERT_SENSOR_DATA, (
+            device_name,
+            data.get('temp'),
+            data.get('hum'),
+            data.get('gas'),
+            data.get('lux'),
+            data.get('life_chance'),
+            data.get('terrain_status'),
+            photo_url,
+            *self.trace_times(trace)
+        ), trace, self.score_mode(data))
+
+    def store_sensor_summary(self, device_name, message, trace=None):
+        data = message.get('data', {})
+        values = [device_name, message.get('window_ms'), data.get('count')]
+        for channel in SUMMARY_CHANNELS:
+            stats = data.get(channel, {})
+            values.extend(stats.get(field) for field in ('min', 'max', 'mean', 'var', 'last'))
+        life = data.get('life_chance', {})
+        values.extend([life.get('max'), life.get('mean'), life.get('last'), data.get('terrain_status')])
+        values.extend(self.trace_times(trace))
+        self.enqueue_store(SQL_INSERT_SENSOR_SUMMARY, values, trace, self.score_mode(data, life.get('count', 1)))
+
+    # --- Estado por dispositivo ---
+
+    def get_device(self, device_name, create=False):
+        shard = self.shards[hash(device_name) % DEVICE_SHARDS]
+        state = shard.devices.get(device_name)
+        if state is None and create:
+            with shard.lock:
+                state = shard.devices.setdefault(device_name, DeviceState(device_name))
+        return state
+
+    def shard_lock(self, device_name):
+        return self.shards[hash(device_name) % DEVICE_SHARDS].lock
+
+    def publish_latest(self, device_name, message, trace=None):
+        """Chamado na ingestão: serializa o último dado uma vez para todos os leitores."""
+        state = self.get_device(device_name, create=True)
+        new_device = state.latest is None
+        if trace:
+            message['trace'] = trace.to_dict()
+        response = CachedResponse(message, self.boot_tag, next(self.versions), trace=trace)
+        if trace:
+            # Antes de publicar: a primeira entrega (serve) mede a partir deste instante
+            trace.published = monotonic_ms()
+            self.trace_stats.record('ingest', trace.published - trace.received)
+            state.last_trace = trace
+        state.latest = message
+        state.latest_response = response
+        if new_device:
+            with self.registry_lock:
+                self.device_names.append(device_name)
+                self.devices_response = CachedResponse(list(self.device_names), self.boot_tag, next(self.versions))
 
-    def setup_data_server(self):
-        self.data_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-        self.data_sock.bind((self.ipHost, self.data_port))
+    def publish_photo(self, photo_url):
+        if photo_url:
+            self.photo_response = CachedResponse({"photo_url": photo_url}, self.boot_tag, next(self.versions))
+        else:
+            self.photo_response = CachedResponse({"error": "Nenhuma foto disponível."}, self.boot_tag, 0, status=404)
+
+    def stats(self):
+        online = sum(1 for shard in self.shards for state in list(shard.devices.values()) if state.session)
+        return {**self.counters, "devices_online": online, "sessions": len(self.sessions),
+                "store_queue": self.store_queue.qsize(), "loop_lag_ms": round(self.loop_lag_ms, 2)}
+
+    @staticmethod
+    def latest_from_summary(message):
+        """Monta o último estado no mesmo formato de 'sensor_data' para o dashboard."""
+        data = message.get('data', {})
+        latest = {channel: data.get(channel, {}).get('last', 0.0) for channel in SUMMARY_CHANNELS}
+        latest['life_chance'] = data.get('life_chance', {}).get('last', 0.0)
+        latest['terrain_status'] = data.get('terrain_status')
+        latest['system_on'] = data.get('system_on')
+        if 'interval_ms' in data:
+            latest['interval_ms'] = data['interval_ms']
+        return {"source": message.get('source'), "type": "sensor_data", "data": latest}
+
+    # --- Laço de eventos ---
+
+    def run_event_loop(self, ready):
+        asyncio.set_event_loop(self.loop)
+        self.loop.run_until_complete(self.setup_data_server())
+        self.loop.run_until_complete(self.setup_command_server())
+        self.loop.create_task(self.housekeeping())
+        ready.set()
+        self.loop.run_forever()
+
+    async def setup_data_server(self):
+        data_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        data_sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, UDP_RECEIVE_BUFFER)
+        data_sock.bind((self.ipHost, self.data_port))
+        await self.loop.create_datagram_endpoint(lambda: DataProtocol(self), sock=data_sock)
         logging.info(f"Ouvindo os dados UDP na porta {self.data_port}")
-        threading.Thread(target=self.process_data, daemon=True).start()
 
-    def setup_command_server(self):
-        self.command_socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        self.command_socket.bind((self.ipHost, self.command_port))
-        self.command_socket.listen(6)
+    async def setup_command_server(self):
+        self.command_server = await asyncio.start_server(self.manage_device_connection, self.ipHost,
+                                                         self.command_port, backlog=DEVICE_BACKLOG)
         logging.info(f"Ouvindo os comandos TCP na porta {self.command_port}")
-        threading.Thread(target=self.start_listening_for_devices, daemon=True).start()
 
-    def process_data(self):
-        while True:
-            try:
-                data, sender_address = self.data_sock.recvfrom(4096)
+    def process_data(self, data, sender_address):
+        """Um datagrama UDP (no laço): decodifica, publica o último dado e enfileira a gravação."""
+        received = monotonic_ms()
+        self.counters['udp_datagrams'] += 1
+        try:
+            if data and data[0] in (CODEC_FRAME_KEY, CODEC_FRAME_DELTA):
+                decoder = self.codec_decoders.setdefault(sender_address, CodecDecoder())
+                decoder.last_seen_ms = received
+                message = decoder.decode(data)
+                if message is None:
+                    return
+            else:
                 message = json.loads(data.decode())
-                device_name = message.get('source')
-                if not device_name:
-                    continue
-                with self.lock:
-                    self.datas[device_name] = message
-                    self.store_sensor_data(device_name, message.get('data', {}))
-            except json.JSONDecodeError:
+            device_name = message.get('source')
+            if not device_name:
+                return
+            state = self.get_device(device_name, create=True)
+            trace = SampleTrace(self.trace_stats, received, message.pop('trace', None), state.clock)
+            if message.get('type') == 'sensor_summary':
+                self.publish_latest(device_name, self.latest_from_summary(message), trace)
+                self.store_sensor_summary(device_name, message, trace)
+            else:
+                self.publish_latest(device_name, message, trace)
+                self.store_sensor_data(device_name, message.get('data', {}), trace=trace)
+        except (json.JSONDecodeError, UnicodeDecodeError, IndexError, ValueError, AttributeError):
+            self.counters['udp_invalid'] += 1
+            if self.counters['udp_invalid'] % 1000 == 1:
                 logging.warning(f"Recebida mensagem UDP mal formatada.")
-            except Exception as e:
-                logging.error(f"Erro no process_data: {e}")
+        except Exception as e:
+            logging.error(f"Erro no process_data: {e}")
 
-    def manage_device_connection(self, connection, sender_address):
-        registered_name = None
-        with connection:
-            logging.info(f"Nova conexão TCP de: {sender_address}")
-            try:
-                while True: 
-                    data = connection.recv(1024).decode()
-                    if not data: 
+    async def manage_device_connection(self, reader, writer):
+        session = DeviceSession(writer)
+        self.sessions.add(session)
+        self.counters['connections'] += 1
+        logging.debug(f"Nova conexão TCP de: {session.address}")
+        decoder = json.JSONDecoder()
+        text = codecs.getincrementaldecoder('utf-8')('replace')
+        buffer = ""
+        try:
+            while True:
+                data = await reader.read(1024)
+                if not data:
+                    break
+                session.last_activity = time.monotonic()
+                # Mensagens JSON podem chegar juntas ou partidas num mesmo read (acks logo após o registro)
+                buffer += text.decode(data)
+                while True:
+                    buffer = buffer.lstrip()
+                    if not buffer:
                         break
-                    message = json.loads(data)
-                    if message.get("type") == "register":
-                        device_name = message.get("name")
-                        if device_name:
-                            with self.lock:
-                                self.devices[device_name] = connection
-                                registered_name = device_name
-                            logging.info(f"Dispositivo '{device_name}' registrado via TCP.")
-                    elif message.get("type") == "command": 
-                        command_type = message.get("command_type")
-                        if command_type == "take_photo":
-                            logging.info(f"Comando 'take_photo' recebido do ESP32 '{registered_name}'.")
-                            self.take_photo(registered_name)
-                        else:
-                            logging.warning(f"Comando desconhecido do ESP32: {command_type}")
-            except (ConnectionResetError, json.JSONDecodeError, socket.timeout):
-                pass 
-            except Exception as e:
-                logging.error(f"Erro em manage_device_connection: {e}")
-            finally:
-                if registered_name:
-                    with self.lock:
-                        if registered_name in self.devices:
-                            del self.devices[registered_name]
-                    logging.info(f"Dispositivo '{registered_name}' desconectado.")
-
-    def start_listening_for_devices(self):
+                    try:
+                        message, end = decoder.raw_decode(buffer)
+                    except json.JSONDecodeError:
+                        break  # Mensagem incompleta: espera o próximo read
+                    buffer = buffer[end:]
+                    self.handle_device_message(session, message)
+                if len(buffer) > DEVICE_MAX_MESSAGE:
+                    raise json.JSONDecodeError("Mensagem TCP inválida", buffer[:64], 0)
+        except (ConnectionError, json.JSONDecodeError):
+            pass
+        except Exception as e:
+            logging.error(f"Erro em manage_device_connection: {e}")
+        finally:
+            session.closed = True
+            self.sessions.discard(session)
+            writer.close()
+            if session.name:
+                state = self.get_device(session.name)
+                with self.shard_lock(session.name):
+                    if state.session is session:
+                        state.session = None
+                logging.info(f"Dispositivo '{session.name}' desconectado.")
+
+    def handle_device_message(self, session, message):
+        if message.get("type") == "register":
+            device_name = message.get("name")
+            if device_name:
+                state = self.get_device(device_name, create=True)
+                with self.shard_lock(device_name):
+                    state.session = session
+                    state.clock = ClockSync()   # Pode ter reiniciado: o millis() recomeçou
+                session.name = device_name
+                logging.info(f"Dispositivo '{device_name}' registrado via TCP.")
+                self.send_time_sync(session)
+        elif message.get("type") == "ack":
+            self.handle_ack(session.name, message)
+        elif message.get("type") == "nack":
+            self.handle_nack(session.name, message)
+        elif message.get("type") == "time_sync":
+            self.handle_time_sync(session, message)
+        elif message.get("type") == "command":
+            command_type = message.get("command_type")
+            if command_type == "take_photo":
+                logging.info(f"Comando 'take_photo' recebido do ESP32 '{session.name}'.")
+                self.loop.run_in_executor(None, self.take_photo, session.name)  # A câmera bloqueia: fora do laço
+            else:
+                logging.warning(f"Comando desconhecido do ESP32: {command_type}")
+
+    def send_time_sync(self, session):
+        """Pede o millis() do dispositivo; a resposta estima o deslocamento do relógio (ClockSync)."""
+        command_id = next(self.command_ids)
+        session.time_sync = (command_id, monotonic_ms())
+        session.next_time_sync = time.monotonic() + TIME_SYNC_INTERVAL
+        self.queue_send(session, (json.dumps({"command": "time_sync", "id": command_id}) + '\n').encode())
+
+    def handle_time_sync(self, session, message):
+        replied = monotonic_ms()
+        if not session.name or not session.time_sync or message.get("id") != session.time_sync[0]:
+            return
+        sent = session.time_sync[1]
+        session.time_sync = None
+        state = self.get_device(session.name)
+        with self.shard_lock(session.name):
+            state.clock.add(sent, replied, message.get("device_ms", 0))
+
+    def queue_send(self, session, data):
+        """Envia sem bloquear quem chama (qualquer thread). Retorna False se a conexão caiu ou se o
+        dispositivo não está lendo e o buffer de escrita passou de DEVICE_WRITE_BUFFER_LIMIT."""
+        if session is None or session.closed or session.buffered() > DEVICE_WRITE_BUFFER_LIMIT:
+            self.counters['writes_rejected'] += 1
+            return False
+        if threading.get_ident() == self.loop_thread.ident:
+            self.write_session(session, data)
+        else:
+            self.loop.call_soon_threadsafe(self.write_session, session, data)
+        return True
+
+    def write_session(self, session, data):
+        # Confere de novo no laço: vários envios de outras threads podem ter passado juntos pelo limite.
+        # O que for recusado aqui o comando pendente retransmite.
+        if session.closed or session.buffered() > DEVICE_WRITE_BUFFER_LIMIT:
+            self.counters['writes_rejected'] += 1
+            return
+        session.writer.write(data)
+
+    async def housekeeping(self):
+        """Retransmissões, conexões e decodificadores ociosos e atraso do laço (quanto o sleep passou do previsto)."""
+        last_idle_check = time.monotonic()
         while True:
-            connection, sender_address = self.command_socket.accept()
-            connection.settimeout(300) 
-            threading.Thread(target=self.manage_device_connection, args=(connection, sender_address), daemon=True).start()
+            before = time.monotonic()
+            await asyncio.sleep(HOUSEKEEPING_INTERVAL)
+            now = time.monotonic()
+            self.loop_lag_ms = max(0.0, (now - before - HOUSEKEEPING_INTERVAL) * 1000.0)
+            self.retry_pending_commands(now)
+            for session in [s for s in self.sessions if s.name and s.next_time_sync <= now]:
+                self.send_time_sync(session)
+            if now - last_idle_check >= DEVICE_IDLE_TIMEOUT / 10:
+                last_idle_check = now
+                for session in [s for s in self.sessions if now - s.last_activity > DEVICE_IDLE_TIMEOUT]:
+                    session.writer.close()
+                # Reinício ou troca da porta de origem deixa o decodificador do endereço antigo para trás
+                idle_ms = (now - DEVICE_IDLE_TIMEOUT) * 1000.0
+                for address in [a for a, d in self.codec_decoders.items() if d.last_seen_ms < idle_ms]:
+                    del self.codec_decoders[address]
+
+    # --- Comandos com confirmação ---
+
+    def send_command(self, device_name, command_type):
+        """Envia um comando com id ao dispositivo e o registra como pendente até o ack."""
+        command_id = next(self.command_ids)
+        payload = (json.dumps({"command": command_type, "id": command_id, "epoch": self.boot_epoch}) + '\n').encode()
+        pending = PendingCommand(command_id, device_name, payload)
+        with self.commands_lock:
+            self.pending_commands[command_id] = pending
+        self.transmit(pending)
+        return pending
+
+    def transmit(self, pending):
+        state = self.get_device(pending.device_name)
+        session = state.session if state else None
+        pending.last_sent = time.monotonic()
+        if pending.first_sent is None:
+            pending.first_sent = pending.last_sent
+        pending.attempts += 1
+        # Dispositivo desconectado ou sem ler: o retry tenta de novo se ele voltar a tempo
+        if not self.queue_send(session, pending.payload):
+            return False
+        logging.debug(f"Comando {pending.id} enviado para '{pending.device_name}' (tentativa {pending.attempts}).")
+        return True
+
+    def finish_command(self, pending, status, result=None):
+        """Conclui o comando uma única vez: ack, nack e a desistência do retry podem disputar o mesmo
+        comando. Retorna False se outro já o concluiu."""
+        with self.commands_lock:
+            if self.pending_commands.pop(pending.id, None) is None:
+                return False
+            pending.status = status
+            pending.result = result
+            self.finished_commands.append(pending)
+        pending.done.set()
+        return True
+
+    def handle_ack(self, device_name, message):
+        now = time.monotonic()
+        with self.commands_lock:
+            pending = self.pending_commands.get(message.get("id"))
+        if not pending or pending.device_name != device_name:
+            return  # Ack atrasado de um comando já concluído ou de outro dispositivo
+        round_trip_ms = (now - pending.first_sent) * 1000.0
+        apply_ms = max(0, message.get("applied_ms", 0) - message.get("received_ms", 0))
+        if not self.finish_command(pending, "acked", {
+            "latency_ms": round(round_trip_ms, 2),
+            "device_apply_ms": apply_ms,
+            "system_on": bool(message.get("system_on")),
+            "duplicate": bool(message.get("duplicate")),
+        }):
+            return
+        state = self.get_device(device_name)
+        with self.shard_lock(device_name):
+            state.round_trip.add(round_trip_ms)
+            if not message.get("duplicate"):
+                state.device_apply.add(apply_ms)
+        logging.debug(f"Ack do comando {pending.id} de '{device_name}' em {round_trip_ms:.1f} ms.")
+
+    def handle_nack(self, device_name, message):
+        """O dispositivo recusou o comando (tipo desconhecido): conclui na hora, sem retransmitir."""
+        with self.commands_lock:
+            pending = self.pending_commands.get(message.get("id"))
+        if not pending or pending.device_name != device_name:
+            return
+        if self.finish_command(pending, "rejected", {"error": message.get("error", "rejected")}):
+            logging.warning(f"Comando {pending.id} recusado por '{device_name}': {message.get('error')}")
+
+    def retry_pending_commands(self, now):
+        """Retransmite comandos sem ack após COMMAND_ACK_TIMEOUT; desiste após COMMAND_MAX_RETRIES."""
+        with self.commands_lock:
+            expired = [p for p in self.pending_commands.values() if now - p.last_sent >= COMMAND_ACK_TIMEOUT]
+        for pending in expired:
+            if pending.attempts > COMMAND_MAX_RETRIES:
+                logging.warning(f"Comando {pending.id} para '{pending.device_name}' sem ack após {pending.attempts} tentativas.")
+                self.finish_command(pending, "failed")
+            else:
+                self.transmit(pending)
+
+    def get_command(self, command_id):
+        with self.commands_lock:
+            pending = self.pending_commands.get(command_id)
+            if pending:
+                return pending
+            for finished in self.finished_commands:
+                if finished.id == command_id:
+                    return finished
+        return None
 
     def take_photo(self, device_name):
         cap = cv2.VideoCapture(0)
@@ -167,90 +1244,143 @@ class Broker:
         cap.release()
 
     def update_latest_sensor_data_with_photo_url(self, device_name, photo_url):
-        try:
-            conn = sqlite3.connect(DB_NAME, check_same_thread=False)
-            cursor = conn.cursor()
-            cursor.execute('''
-                UPDATE sensor_data
-                SET photo_url = ?
-                WHERE id = (
-                    SELECT id FROM sensor_data
-                    WHERE device_name = ?
-                    ORDER BY timestamp DESC
-                    LIMIT 1
-                )
-            ''', (photo_url, device_name))
-            conn.commit()
-            conn.close()
-            if cursor.rowcount > 0:
-                logging.info(f"URL da foto '{photo_url}' atualizado no último registro de '{device_name}'.")
-            else:
-                logging.warning(f"Não foi encontrado registro para atualizar com a foto para '{device_name}'.")
-        except Exception as e:
-            logging.error(f"Erro ao atualizar URL da foto no banco de dados: {e}")
+        # A URL vale na hora para /photos/latest; o UPDATE entra na fila, depois das leituras já enfileiradas
+        self.publish_photo(photo_url)
+        self.enqueue_store(SQL_UPDATE_PHOTO, (photo_url, device_name))
+        logging.info(f"URL da foto '{photo_url}' associado ao último registro de '{device_name}'.")
 
 app = Flask(__name__)
-CORS(app)
+CORS(app, expose_headers=["ETag", "X-Sample-Age-Ms"])
 broker = Broker(DATA_PORT, COMMAND_PORT)
 
 @app.route('/', methods=['GET'])
 def index():
     return jsonify({"status": "broker_online", "version": "1.2", "message": "Robo Explorador API"})
 
+# As rotas de leitura só pegam a referência da resposta pronta (sem trava e sem serializar): o custo
+# de cada consulta não depende de quantos dashboards estão abertos, e o que não mudou volta como 304.
 @app.route('/devices', methods=['GET'])
 def get_devices():
-    return jsonify(list(broker.datas.keys()))
+    return broker.devices_response.respond()
 
 @app.route('/devices/<device_name>/data', methods=['GET'])
 def get_device_data_api(device_name):
-    with broker.lock:
-        if device_name not in broker.devices:
-            return jsonify({"status": "offline", "message": f"Dispositivo '{device_name}' não encontrado ou offline."}), 404
-        latest_data = broker.datas.get(device_name)
-        if latest_data:
-            response = jsonify(latest_data)
-            status_code = 200
-        else:
-            response = jsonify({"status": "waiting_for_data", "message": f"Dispositivo '{device_name}' conectado, aguardando dados."})
-            status_code = 200
-    response.status_code = status_code
+    state = broker.get_device(device_name)
+    if not state or not state.session:
+        response = jsonify({"status": "offline", "message": f"Dispositivo '{device_name}' não encontrado ou offline."})
+        response.status_code = 404
+    else:
+        cached = state.latest_response
+        if cached:
+            return cached.respond()
+        response = jsonify({"status": "waiting_for_data", "message": f"Dispositivo '{device_name}' conectado, aguardando dados."})
     response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
     return response
 
 @app.route('/devices/<device_name>/command', methods=['POST'])
 def send_command_api(device_name):
-    with broker.lock:
-        connection = broker.devices.get(device_name)
-    if not connection:
+    state = broker.get_device(device_name)
+    if not state or not state.session:
         return jsonify({'error': f"Dispositivo '{device_name}' não está conectado para receber comandos."}), 404
     command_data = request.json
     if not command_data or 'command_type' not in command_data:
         return jsonify({'error': 'Payload do comando inválido.'}), 400
-    try:
-        command_payload = json.dumps({"command": command_data['command_type']})
-        connection.sendall((command_payload + '\n').encode()) 
-        logging.info(f"Comando '{command_payload}' enviado para: '{device_name}'")
-        return jsonify({'message': f"Comando '{command_data['command_type']}' enviado."}), 200
-    except Exception as e:
-        logging.error(f"Erro ao enviar comando para '{device_name}': {e}")
-        return jsonify({'error': 'Falha ao enviar comando para o dispositivo.'}), 500
+    # Não espera o ack: o resultado (estado aplicado, latência) sai em /commands/<id>
+    pending = broker.send_command(device_name, command_data['command_type'])
+    response = jsonify({'message': f"Comando '{command_data['command_type']}' enviado.", **pending.to_dict()})
+    response.status_code = 202
+    response.headers["Location"] = f"/devices/{device_name}/commands/{pending.id}"
+    return response
 
-@app.route('/photos/latest', methods=['GET'])
-def get_latest_photo_url():
-    with broker.lock:
-        conn = sqlite3.connect(DB_NAME, check_same_thread=False)
-        cursor = conn.cursor()
-        cursor.execute("SELECT photo_url FROM sensor_data WHERE photo_url IS NOT NULL ORDER BY timestamp DESC LIMIT 1")
-        result = cursor.fetchone()
-        conn.close()
-        if result and result[0]:
-            response = jsonify({"photo_url": result[0]})
-        else:
-            response = jsonify({"error": "Nenhuma foto disponível."})
-            response.status_code = 404
+@app.route('/devices/<device_name>/commands/<int:command_id>', methods=['GET'])
+def get_command_api(device_name, command_id):
+    pending = broker.get_command(command_id)
+    if not pending or pending.device_name != device_name:
+        return jsonify({'error': f"Comando {command_id} não encontrado."}), 404
+    return jsonify(pending.to_dict()), COMMAND_STATUS_HTTP[pending.status]
+
+@app.route('/devices/<device_name>/latency', methods=['GET'])
+def get_device_latency_api(device_name):
+    state = broker.get_device(device_name) or DeviceState(device_name)
+    with broker.shard_lock(device_name):
+        round_trip = state.round_trip.to_dict()
+        device_apply = state.device_apply.to_dict()
+    with broker.commands_lock:
+        in_flight = sum(1 for p in broker.pending_commands.values() if p.device_name == device_name)
+    response = jsonify({"device": device_name, "round_trip": round_trip, "device_apply": device_apply, "in_flight": in_flight})
+    response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
+    return response
+
+@app.route('/trace', methods=['GET'])
+def get_trace_api():
+    """Latência por etapa (toda a frota): a etapa com o maior p95 é o gargalo."""
+    synced = sum(1 for shard in broker.shards for state in list(shard.devices.values()) if state.clock.offset_ms is not None)
+    response = jsonify({"hops": broker.trace_stats.to_dict(), "clock_synced_devices": synced})
+    response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
+    return response
+
+@app.route('/devices/<device_name>/trace', methods=['GET'])
+def get_device_trace_api(device_name):
+    state = broker.get_device(device_name)
+    if not state:
+        return jsonify({'error': f"Dispositivo '{device_name}' não encontrado."}), 404
+    trace = state.last_trace
+    last = None
+    if trace:
+        origin = trace.origin()
+        last = {**trace.to_dict(), "steps_ms": {
+            "device_queue": None if trace.capture is None or trace.send is None else round(trace.send - trace.capture, 1),
+            "network": None if trace.send is None else round(trace.received - trace.send, 1),
+            "ingest": None if trace.published is None else round(trace.published - trace.received, 2),
+            "store": None if trace.committed is None else round(trace.committed - trace.received, 1),
+            "serve": None if trace.served is None else round(trace.served - trace.published, 1),
+            "first_serve_age": None if trace.served is None else round(trace.served - origin, 1),
+        }}
+    response = jsonify({"device": device_name, "clock": state.clock.to_dict(), "last_sample": last})
+    response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
+    return response
+
+@app.route('/devices/<device_name>/trace/render', methods=['POST'])
+def report_render_api(device_name):
+    """Relatos do dashboard: idade da amostra na entrega, duração do fetch e tempo até o desenho."""
+    accepted = 0
+    for report in (request.json or {}).get('reports', [])[:TRACE_REPORT_MAX]:
+        try:
+            age, fetch, render = float(report['age_ms']), float(report['fetch_ms']), float(report['render_ms'])
+        except (KeyError, TypeError, ValueError):
+            continue
+        # A resposta leva ~metade do fetch para chegar ao navegador depois de a idade ser medida
+        broker.trace_stats.record('render', render)
+        broker.trace_stats.record('end_to_end', age + fetch / 2.0 + render)
+        accepted += 1
+    return jsonify({"accepted": accepted})
+
+@app.route('/archive', methods=['GET'])
+def get_archive_api():
+    """Segmentos selados do histórico (consultas e reavaliação: source/host/archive_scan.c)."""
+    segments = broker.archive.segments()
+    response = jsonify({"directory": os.path.abspath(ARCHIVE_DIR), "rows": sum(s['rows'] for s in segments),
+                        "bytes": sum(s['bytes'] for s in segments), "segments": segments})
+    response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
+    return response
+
+@app.route('/model', methods=['GET'])
+def get_model_api():
+    """Modelo do servidor e concordância com a chance de vida enviada por cada dispositivo."""
+    response = jsonify({**broker.scorer.to_dict(), "devices": broker.model_agreement.to_dict()})
     response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
     return response
 
+@app.route('/broker/stats', methods=['GET'])
+def get_broker_stats_api():
+    response = jsonify(broker.stats())
+    response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate"
+    return response
+
+@app.route('/photos/latest', methods=['GET'])
+def get_latest_photo_url():
+    return broker.photo_response.respond()
+
 @app.route('/photos/<filename>')
 def serve_photo(filename):
     response = make_response(send_from_directory(PHOTOS_DIR, filename))
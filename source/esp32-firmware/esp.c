@@ -1,4 +1,4 @@
-// Executar no Arduino IDE com as dependências instaladas e com o arquivo ia_model.h no mesmo diretório
+// Executar no Arduino IDE com as dependências instaladas e com os arquivos ia_model.h, ia_model.c, ia_model_gen.h, ia_features.h, ia_features.c, telemetry_summary.h, telemetry_summary.c, telemetry_codec.h, telemetry_codec.c, spsc_queue.h, pipeline.h, pipeline.c, adaptive_rate.h, adaptive_rate.c, async_log.h, async_log.c e log_messages.h no mesmo diretório
 
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
@@ -7,6 +7,13 @@
 #include <HTTPClient.h>      // Pode ser útil para futuras extensões ou outras APIs (mantido por ser padrão)
 #include <ArduinoJson.h>     // Para manipulação de JSON (necessário para broker e comandos)
 #include "ia_model.h"        // Seu modelo de IA
+#include "ia_features.h"     // Janelas deslizantes com as características temporais
+#include "telemetry_summary.h" // Resumo estatístico da telemetria por janela
+#include "telemetry_codec.h" // Codec binário delta + varint da telemetria
+#include "pipeline.h"        // Pipeline aquisição (núcleo 1) -> rede (núcleo 0) com filas SPSC
+#include "adaptive_rate.h"   // Taxa de amostragem e da IA adaptada à atividade do sinal
+#include "async_log.h"       // Log assíncrono: registros num anel, formatados pela tarefa de log
+#include <atomic>
 
 // --- Mapeamento dos Sensores e Componentes ---
 #define ADC1_0 36 // Sensor de Temperatura (Assumindo sensor analógico)
@@ -45,13 +52,93 @@ const unsigned long botInterval = 1000; // 1s para checar mensagens do bot
 
 
 // --- Controle de Leitura e Envio ---
-unsigned long lastSensorReadAndSend = 0;
-const unsigned long SENSOR_READ_INTERVAL = 500; // 0,5s
-unsigned long lastAINNPrediction = 0;
-const unsigned long AI_PREDICTION_INTERVAL = 1000; // 1s
-
-volatile bool buttonPressed = false;
-bool systemOn = true; // Controla se os sensores e IA estão ativos
+const unsigned long SENSOR_READ_INTERVAL = 500; // 0,5s (intervalo base)
+const unsigned long AI_PREDICTION_INTERVAL = 1000; // 1s (no intervalo base)
+// Com ADAPTIVE_RATE os intervalos caem para 0,25s com o sinal mudando rápido e sobem até 2s com
+// o terreno estável (adaptive_rate.h); sem ele ficam fixos nos valores acima.
+const bool ADAPTIVE_RATE = true;
+
+// --- Modo de Telemetria ---
+// RAW: envia toda leitura ao broker (a cada 0,5s)
+// SUMMARY: envia um resumo estatístico por janela e leituras brutas só ao redor dos cruzamentos de limiar
+// CODEC: envia toda leitura, mas em quadros binários delta + varint (telemetry_codec.h)
+// O padrão é RAW: o dashboard, o ETag do broker e o rastreio de latência contam com uma amostra a
+// cada leitura. Para trocar de modo, defina TELEMETRY_MODE abaixo com TELEMETRY_MODE_SUMMARY ou
+// TELEMETRY_MODE_CODEC e regrave o firmware.
+#define TELEMETRY_MODE_RAW     0
+#define TELEMETRY_MODE_SUMMARY 1
+#define TELEMETRY_MODE_CODEC   2
+#define TELEMETRY_MODE TELEMETRY_MODE_RAW
+
+// A janela fecha por número de ciclos, para a redução não depender do intervalo adaptativo:
+// 24 leituras brutas (~300 B cada) viram um resumo de ~700 B, ~10x menos bytes em qualquer taxa.
+// O limite de tempo só segura a latência do dashboard com a taxa mínima.
+const unsigned long SUMMARY_WINDOW_SAMPLES = 24;    // ~12s no intervalo base de 0,5s
+const unsigned long SUMMARY_WINDOW_MAX_MS = 60000;  // 60s no máximo por resumo
+const int RAW_SAMPLES_AFTER_CROSSING = 2;           // Leituras brutas enviadas após um cruzamento
+TelemetrySummary summary;
+CodecEncoder codecEncoder;
+
+// --- Log ---
+// TEXT: a tarefa de log formata cada registro e escreve a linha na serial
+// BINARY: escreve quadros compactos (async_log.h); decodificar no host com source/host/log_decode.c
+// O nível mínimo é LOG_LEVEL (async_log.h); defina antes do #include para mudar.
+// Mensagens do setup/conexão Wi-Fi (que podem terminar em reinício) continuam direto na Serial.
+// Texto recebido do broker não vai para o log (%s só aceita literais): registra-se o id do comando.
+#define LOG_OUTPUT_TEXT   0
+#define LOG_OUTPUT_BINARY 1
+#define LOG_OUTPUT LOG_OUTPUT_TEXT
+
+// --- Pipeline entre os Núcleos ---
+// Núcleo 1: leitura do ADC, janelas de características e IA (tarefa de tempo real)
+// Núcleo 0: Wi-Fi, broker, telemetria e Telegram (junto com a pilha de rede do ESP32)
+const BaseType_t ACQUISITION_CORE = 1;
+const BaseType_t NETWORK_CORE = 0;
+const UBaseType_t ACQUISITION_PRIORITY = 3;
+const UBaseType_t NETWORK_PRIORITY = 1;
+const uint32_t ACQUISITION_STACK = 4096;
+const uint32_t NETWORK_STACK = 12288;         // TLS do Telegram precisa de pilha maior
+const unsigned long NETWORK_TASK_PERIOD = 10; // ms entre as passadas da tarefa de rede
+const UBaseType_t LOG_PRIORITY = 0;           // Abaixo da rede: a serial só anda com CPU sobrando
+const uint32_t LOG_STACK = 3072;
+const unsigned long LOG_TASK_PERIOD = 20;     // ms entre as drenagens do anel de log
+// Entre duas leituras a tarefa de aquisição acorda a cada COMMAND_POLL_INTERVAL para aplicar comandos.
+// Ajuste com o histograma de latência do broker (/devices/<nome>/latency); deve dividir SENSOR_READ_INTERVAL.
+const unsigned long COMMAND_POLL_INTERVAL = 50;
+
+PipelineSample sampleStorage[PIPELINE_SAMPLE_QUEUE_SIZE];
+PipelineCommand commandStorage[PIPELINE_COMMAND_QUEUE_SIZE];
+PipelineAck ackStorage[PIPELINE_ACK_QUEUE_SIZE];
+SpscQueue sampleQueue;    // Aquisição -> rede
+SpscQueue commandQueue;   // Rede -> aquisição
+SpscQueue ackQueue;       // Aquisição -> rede (confirmação dos comandos aplicados)
+
+// Maior id de comando já recebido do broker: retransmissões com id repetido não alternam o sistema
+// outra vez. Vale entre reconexões (o ack perdido com a conexão é justamente o caso da
+// retransmissão); só zera quando a época do broker muda (broker reiniciado).
+uint32_t lastCommandId = 0;
+uint32_t lastCommandEpoch = 0;
+// Maior id já aplicado pela tarefa de aquisição (escrito junto com o PipelineAck). Só esses são
+// confirmados de novo numa retransmissão; um id ainda na fila espera o ack verdadeiro, com o
+// estado depois do toggle.
+std::atomic<uint32_t> lastAppliedCommandId(0);
+
+// Intervalo de amostragem em vigor, informado na telemetria (só a tarefa de rede usa)
+unsigned long currentSampleInterval = SENSOR_READ_INTERVAL;
+
+// Rastro da latência: instante de captura (millis() na aquisição) da amostra sendo enviada e
+// sequência das mensagens de telemetria. O broker converte os instantes para o relógio dele com
+// o deslocamento estimado pelos comandos time_sync.
+unsigned long currentCaptureTick = 0;
+uint32_t traceSequence = 0;
+AcquisitionState acquisition;
+
+// Última amostra recebida pela tarefa de rede (usada pelo /sensores do Telegram)
+PipelineSample latestSample;
+bool hasLatestSample = false;
+
+std::atomic<bool> buttonPressed(false);
+std::atomic<bool> systemOn(true); // Controla se os sensores e IA estão ativos (só a tarefa de aquisição escreve)
 
 // --- Comunicação TCP com Broker ---
 WiFiClient brokerClient;
@@ -64,53 +151,54 @@ const unsigned long PHOTO_COMMAND_COOLDOWN = 30000; // 30 segundos de cooldown p
 
 // --- Prototipação ---
 void IRAM_ATTR handleButtonInterrupt();
+void acquisitionTask(void* parameter);
+void networkTask(void* parameter);
+void handlePipelineSample(const PipelineSample& sample);
+void logTask(void* parameter);
+uint32_t logClock();
+void sendAckToBroker(uint32_t id, unsigned long received_ms, unsigned long applied_ms, bool system_on, bool duplicate);
+void sendTimeSyncToBroker(uint32_t id);
+void sendRejectToBroker(uint32_t id, const char* error);
 void connectWiFi();
 void connectBrokerTCP();
 void handleBrokerCommands();
-void sendDataToBrokerUDP(float temp, float hum, float gas, float lux, float life_chance, bool system_on, const char* terrain_status);
+void sendDataToBrokerUDP(float temp, float hum, float gas, float lux, float life_chance, bool predicted, bool system_on, const char* terrain_status, unsigned long capture_ms);
+void handleSummaryTelemetry(float temp, float hum, float gas, float lux, float life_chance, bool predicted, bool system_on, const char* terrain_status);
+void sendSummaryToBrokerUDP(bool system_on, bool predicted, const char* terrain_status);
+void sendCompressedToBrokerUDP(int rawTemp, int rawHum, int rawGas, int rawLux, float life_chance, bool predicted, bool system_on);
 void handleTelegramMessages();
 void sendTelegramLifeMessage(float temp, float hum, float gas, float lux, float life_chance, const char* terrain_status);
 void sendTakePhotoCommandToBroker(); // NOVA FUNÇÃO PARA ENVIAR COMANDO DE FOTO
 
-// --- IA (mantido do seu código) ---
-// Certifique-se de que o arquivo ia_model.h está no mesmo diretório do .ino
-// e que ele define INPUT_SIZE, HIDDEN_SIZE, W1, b1, W2, b2.
-float relu(float x) { return x > 0 ? x : 0; }
-float sigmoid(float x) { return 1.0f / (1.0f + expf(-x)); }
-
-float model_predict(const float x[INPUT_SIZE]) {
-  float hidden[HIDDEN_SIZE];
-  for (int i = 0; i < HIDDEN_SIZE; ++i) {
-    hidden[i] = b1[i];
-    for (int j = 0; j < INPUT_SIZE; ++j) {
-      hidden[i] += x[j] * W1[j][i];
-    }
-    hidden[i] = relu(hidden[i]);
-  }
-
-  float output = b2;
-  for (int i = 0; i < HIDDEN_SIZE; ++i) {
-    output += hidden[i] * W2[i];
-  }
-  return sigmoid(output);
-}
-
-void normalize_readings(float input[INPUT_SIZE]) {
-  // Normaliza os valores de entrada dos sensores para o formato esperado pela IA (0-1)
-  input[0] /= MAX_TEMPERATURE_READING;
-  input[1] /= 100.0f; // Umidade já é em % (0-100), então divide por 100 para normalizar para 0-1
-  input[2] /= MAX_GAS_READING;
-  input[3] /= MAX_LIGHT_READING;
-}
+// --- IA ---
+// relu, sigmoid, model_predict, model_predict_ext e normalize_readings vêm de ia_model.c (copiado para
+// este diretório junto com o ia_model.h): é o mesmo código que source/host/model_conformance.c
+// confere contra os vetores de referência, então não há cópia à mão para divergir.
 
 // --- Setup ---
 void setup() {
   Serial.begin(9600); // MANTIDO EM 9600 BAUD RATE CONFORME SOLICITADO
   delay(100); // Pequeno delay para serial iniciar
+  log_init(logClock);
+  xTaskCreatePinnedToCore(logTask, "log", LOG_STACK, NULL, LOG_PRIORITY, NULL, NETWORK_CORE);
 
   pinMode(BUTTON, INPUT_PULLUP);
   attachInterrupt(digitalPinToInterrupt(BUTTON), handleButtonInterrupt, FALLING);
 
+  spsc_init(&sampleQueue, sampleStorage, sizeof(PipelineSample), PIPELINE_SAMPLE_QUEUE_SIZE);
+  spsc_init(&commandQueue, commandStorage, sizeof(PipelineCommand), PIPELINE_COMMAND_QUEUE_SIZE);
+  spsc_init(&ackQueue, ackStorage, sizeof(PipelineAck), PIPELINE_ACK_QUEUE_SIZE);
+  RateConfig rateConfig = RATE_CONFIG_DEFAULT(SENSOR_READ_INTERVAL);
+  if (!ADAPTIVE_RATE) {
+    // Limiares acima de qualquer variação normalizada possível: o intervalo nunca sai do base
+    rateConfig.min_interval_ms = rateConfig.max_interval_ms = SENSOR_READ_INTERVAL;
+    rateConfig.enter_delta = rateConfig.exit_delta = 2.0f;
+    rateConfig.enter_slope = rateConfig.exit_slope = 2.0f;
+  }
+  pipeline_acquisition_init(&acquisition, &rateConfig, AI_PREDICTION_INTERVAL);
+  summary_reset(&summary, millis());
+  codec_encoder_init(&codecEncoder);
+
   // Inicializa Wi-Fi
   connectWiFi();
 
@@ -121,116 +209,220 @@ void setup() {
   // Conecta ao broker TCP para comandos
   connectBrokerTCP();
 
+  xTaskCreatePinnedToCore(acquisitionTask, "aquisicao", ACQUISITION_STACK, NULL, ACQUISITION_PRIORITY, NULL, ACQUISITION_CORE);
+  xTaskCreatePinnedToCore(networkTask, "rede", NETWORK_STACK, NULL, NETWORK_PRIORITY, NULL, NETWORK_CORE);
+
   Serial.println("Setup completo.");
 }
 
 // --- Loop Principal ---
+// Todo o trabalho acontece nas tarefas do pipeline; a tarefa do loop() do Arduino não é mais necessária
 void loop() {
-  unsigned long currentTime = millis();
+  vTaskDelete(NULL);
+}
 
-  // === Gerenciamento de Conexão Wi-Fi ===
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("Wi-Fi desconectado. Tentando reconectar...");
-    connectWiFi(); // Tenta reconectar
-  }
+// --- Tarefa de Aquisição (núcleo 1) ---
+// Lê os sensores e roda a IA no intervalo decidido pelo controle de taxa, sem nunca esperar pela rede.
+// Comandos são aplicados a cada COMMAND_POLL_INTERVAL, também entre as leituras.
+void acquisitionTask(void* parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
+  unsigned long slice = 0;
+  uint8_t events = 0;
+
+  for (;;) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(COMMAND_POLL_INTERVAL));
+
+    // Aplica os comandos vindos da tarefa de rede e confirma cada um com o estado resultante
+    PipelineCommand command;
+    while (spsc_pop(&commandQueue, &command)) {
+      if (command.type == PIPELINE_COMMAND_TOGGLE_SYSTEM) {
+        systemOn.store(!systemOn.load());
+        events |= PIPELINE_EVENT_REMOTE_TOGGLE;
+        if (command.id != 0) {
+          lastAppliedCommandId.store(command.id);
+        }
+        PipelineAck ack = { command.id, command.received_ms, millis(), (uint8_t)systemOn.load() };
+        spsc_push(&ackQueue, &ack);
+      }
+    }
+    if (buttonPressed.exchange(false)) {
+      systemOn.store(!systemOn.load());
+      events |= PIPELINE_EVENT_BUTTON_TOGGLE;
+    }
 
-  // === Gerenciamento de Conexão TCP com Broker ===
-  if (!brokerClient.connected()) {
-    Serial.println("Conexão TCP com broker perdida. Tentando reconectar...");
-    connectBrokerTCP(); // Tenta reconectar
-  } else {
-    handleBrokerCommands(); // Processa comandos recebidos do broker (Ex: toggle_system_state)
+    if (++slice < acquisition.rate.interval_ms / COMMAND_POLL_INTERVAL) {
+      continue;
+    }
+    slice = 0;
+
+    bool on = systemOn.load();
+    int32_t raw[PIPELINE_CHANNELS] = { 0, 0, 0, 0 };
+    if (on) {
+      // Leitura dos sensores
+      raw[0] = analogRead(ADC1_0);
+      raw[1] = analogRead(ADC1_3);
+      raw[2] = analogRead(ADC1_6);
+      raw[3] = analogRead(ADC1_7);
+    }
+
+    PipelineSample sample;
+    pipeline_acquire(&acquisition, raw, on, millis(), &sample);
+    sample.events = events;
+    events = 0;
+    spsc_push(&sampleQueue, &sample); // Com a fila cheia a amostra é descartada e contada em sampleQueue.dropped
   }
+}
+
+// --- Tarefa de Log (núcleo 0, prioridade mínima) ---
+// Drena o anel de log: só aqui a escrita na serial pode bloquear
+void logTask(void* parameter) {
+  uint32_t reportedDrops = 0;
+  LogRecord record;
+
+  for (;;) {
+    while (log_pop(&record)) {
+#if LOG_OUTPUT == LOG_OUTPUT_BINARY
+      uint8_t frame[LOG_MAX_FRAME];
+      size_t length = log_encode_record(&record, frame, sizeof(frame));
+      Serial.write(frame, length);
+#else
+      char line[LOG_MAX_LINE];
+      size_t length = log_format_record(&record, line, sizeof(line));
+      Serial.write((const uint8_t*)line, length);
+#endif
+    }
+
+    // Descartes são informados pela própria tarefa, sem passar pelo anel cheio
+    uint32_t drops = log_dropped();
+    if (drops != reportedDrops) {
+      LogRecord dropped = { logClock(), LOG_MSG_DROPPED, LOG_LEVEL_WARN, 1 };
+      dropped.args[0].u = drops - reportedDrops;
+      reportedDrops = drops;
+#if LOG_OUTPUT == LOG_OUTPUT_BINARY
+      uint8_t frame[LOG_MAX_FRAME];
+      Serial.write(frame, log_encode_record(&dropped, frame, sizeof(frame)));
+#else
+      char line[LOG_MAX_LINE];
+      Serial.write((const uint8_t*)line, log_format_record(&dropped, line, sizeof(line)));
+#endif
+    }
 
-  // === Leitura de Sensores, IA e Envio de Dados (a cada 0.5s) ===
-  if (currentTime - lastSensorReadAndSend >= SENSOR_READ_INTERVAL) {
-    lastSensorReadAndSend = currentTime;
+    vTaskDelay(pdMS_TO_TICKS(LOG_TASK_PERIOD));
+  }
+}
 
-    Serial.println("============================================");
+uint32_t logClock() {
+  return millis();
+}
 
-    float temp = 0.0f;
-    float hum = 0.0f;
-    float gas = 0.0f;
-    float lux = 0.0f;
-    float chance = 0.0f;
-    const char* terrain_status = "Desativado"; // Valor padrão para quando o sistema está desligado
+// --- Tarefa de Rede (núcleo 0) ---
+void networkTask(void* parameter) {
+  for (;;) {
+    unsigned long currentTime = millis();
 
-    if (systemOn) {
-      // Leitura dos sensores
-      int rawTemp = analogRead(ADC1_0);
-      int rawHum  = analogRead(ADC1_3);
-      int rawGas  = analogRead(ADC1_6);
-      int rawLux  = analogRead(ADC1_7);
-
-      // Converte leituras ADC (0-4095) para valores reais com base nos MAX_ definidos
-      temp = ((float)rawTemp / 4095.0f) * MAX_TEMPERATURE_C;
-      hum  = ((float)rawHum / 4095.0f) * 100.0f; // Umidade em %
-      gas  = ((float)rawGas / 4095.0f) * MAX_GAS_PPM;
-      lux  = ((float)rawLux / 4095.0f) * MAX_LIGHT_CD;
-
-      Serial.printf("Temperatura: %.2f °C\n", temp);
-      Serial.printf("Umidade: %.2f %%\n", hum);
-      Serial.printf("Gás: %.2f ppm\n", gas);
-      Serial.printf("Luminosidade: %.2f cd\n", lux);
-
-      // === Avaliação da Rede Neural (a cada 1s) ===
-      // A IA só roda se o sistema estiver ligado e no intervalo definido
-      if (currentTime - lastAINNPrediction >= AI_PREDICTION_INTERVAL) {
-        lastAINNPrediction = currentTime; // Atualiza o tempo da última predição da IA
+    // === Gerenciamento de Conexão Wi-Fi ===
+    if (WiFi.status() != WL_CONNECTED) {
+      LOG_WARN(LOG_MSG_WIFI_LOST);
+      connectWiFi(); // Tenta reconectar
+    }
 
-        float input[INPUT_SIZE] = { temp, hum, gas, lux };
-        normalize_readings(input); // Normaliza para a IA
-        chance = model_predict(input); // Executa a predição da IA
-
-        Serial.printf("Chance de vida: %.2f%%\n", chance * 100);
-        if (chance >= 0.70) {
-          terrain_status = "Propício à vida ✅";
-          Serial.println("Status do planeta: Propício à vida ✅");
-          
-          // === Requisito 4.3.7: Mensagem no WhatsApp (Telegram) se propício a vida ===
-          sendTelegramLifeMessage(temp, hum, gas, lux, chance, terrain_status);
-          
-          // === NOVO: Requisito 4.3.11: Comandar foto se propício à vida ===
-          sendTakePhotoCommandToBroker();
-        } else if (chance >= 0.5) {
-          terrain_status = "Condição Moderada 🟨";
-          Serial.println("Status do planeta: Condição Moderada 🟨");
-        } else {
-          terrain_status = "Ambiente Hostil ❌";
-          Serial.println("Status do planeta: Ambiente Hostil ❌");
-        }
-      }
+    // === Gerenciamento de Conexão TCP com Broker ===
+    if (!brokerClient.connected()) {
+      LOG_WARN(LOG_MSG_BROKER_LOST);
+      connectBrokerTCP(); // Tenta reconectar
     } else {
-      Serial.println("Sensores e IA desativados.");
+      handleBrokerCommands(); // Processa comandos recebidos do broker (Ex: toggle_system_state)
+    }
+
+    // === Confirmações dos comandos aplicados ===
+    PipelineAck ack;
+    while (spsc_pop(&ackQueue, &ack)) {
+      sendAckToBroker(ack.id, ack.received_ms, ack.applied_ms, ack.system_on, false);
     }
 
-    Serial.print("Status Wi-Fi: ");
-    Serial.println(WiFi.status() == WL_CONNECTED ? "Conectado" : "Desconectado");
-    Serial.print("Status do Sistema: ");
-    Serial.println(systemOn ? "Ligado" : "Desligado");
-  
-    sendDataToBrokerUDP(temp, hum, gas, lux, chance, systemOn, terrain_status);
+    // === Amostras produzidas pela tarefa de aquisição ===
+    PipelineSample sample;
+    while (spsc_pop(&sampleQueue, &sample)) {
+      handlePipelineSample(sample);
+    }
+
+    if (currentTime - lastTimeBotRan > botInterval) {
+      handleTelegramMessages();
+      lastTimeBotRan = currentTime;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_PERIOD));
   }
+}
 
+// Exibe, notifica e envia ao broker uma amostra vinda do pipeline
+void handlePipelineSample(const PipelineSample& sample) {
+  latestSample = sample;
+  hasLatestSample = true;
 
-  if (buttonPressed) {
-    buttonPressed = false;
-    systemOn = !systemOn;
-    Serial.printf("Sistema agora: %s\n", systemOn ? "Ligado" : "Desligado");
+  if (sample.events & (PIPELINE_EVENT_BUTTON_TOGGLE | PIPELINE_EVENT_REMOTE_TOGGLE)) {
+    bool remote = sample.events & PIPELINE_EVENT_REMOTE_TOGGLE;
+    LOG_INFO(LOG_MSG_TOGGLE, remote ? "Comando remoto" : "Botão", sample.system_on ? "Ligado" : "Desligado");
+  }
+  if (sample.events & PIPELINE_EVENT_BUTTON_TOGGLE) {
     String notification = "{\"type\":\"notification\",\"name\":\"";
     notification += DEVICE_NAME;
     notification += "\",\"action\":\"";
-    notification += (systemOn ? "system_activated" : "system_deactivated");
+    notification += (sample.system_on ? "system_activated" : "system_deactivated");
     notification += "\"}";
     if (brokerClient.connected()) {
       brokerClient.print(notification);
     }
   }
 
-  if (currentTime - lastTimeBotRan > botInterval) {
-    handleTelegramMessages();
-    lastTimeBotRan = currentTime;
+  LOG_INFO(LOG_MSG_SEPARATOR);
+
+  const char* terrain_status = "Desativado"; // Valor padrão para quando o sistema está desligado
+  currentSampleInterval = sample.interval_ms;
+  currentCaptureTick = sample.tick_ms;
+
+  if (sample.system_on) {
+    LOG_INFO(LOG_MSG_TEMPERATURE, sample.temp);
+    LOG_INFO(LOG_MSG_HUMIDITY, sample.hum);
+    LOG_INFO(LOG_MSG_GAS, sample.gas);
+    LOG_INFO(LOG_MSG_LIGHT, sample.lux);
+
+    LOG_INFO(LOG_MSG_INTERVAL, (unsigned long)sample.interval_ms, sample.rate_active ? " (sinal em mudança)" : "");
+
+    // === Avaliação da Rede Neural (no intervalo adaptativo, feita na tarefa de aquisição) ===
+    if (sample.predicted) {
+      LOG_INFO(LOG_MSG_LIFE_CHANCE, sample.life_chance * 100);
+      if (sample.terrain_class == CODEC_TERRAIN_FAVORABLE) {
+        terrain_status = "Propício à vida ✅";
+        LOG_INFO(LOG_MSG_PLANET_STATUS, terrain_status);
+
+        // === Requisito 4.3.7: Mensagem no WhatsApp (Telegram) se propício a vida ===
+        sendTelegramLifeMessage(sample.temp, sample.hum, sample.gas, sample.lux, sample.life_chance, terrain_status);
+
+        // === NOVO: Requisito 4.3.11: Comandar foto se propício à vida ===
+        sendTakePhotoCommandToBroker();
+      } else if (sample.terrain_class == CODEC_TERRAIN_MODERATE) {
+        terrain_status = "Condição Moderada 🟨";
+        LOG_INFO(LOG_MSG_PLANET_STATUS, terrain_status);
+      } else {
+        terrain_status = "Ambiente Hostil ❌";
+        LOG_INFO(LOG_MSG_PLANET_STATUS, terrain_status);
+      }
+    }
+  } else {
+    LOG_INFO(LOG_MSG_SENSORS_OFF);
   }
+
+  LOG_INFO(LOG_MSG_WIFI_STATUS, WiFi.status() == WL_CONNECTED ? "Conectado" : "Desconectado");
+  LOG_INFO(LOG_MSG_SYSTEM_STATUS, sample.system_on ? "Ligado" : "Desligado");
+
+#if TELEMETRY_MODE == TELEMETRY_MODE_SUMMARY
+  handleSummaryTelemetry(sample.temp, sample.hum, sample.gas, sample.lux, sample.life_chance, sample.predicted, sample.system_on, terrain_status);
+#elif TELEMETRY_MODE == TELEMETRY_MODE_CODEC
+  sendCompressedToBrokerUDP(sample.raw[0], sample.raw[1], sample.raw[2], sample.raw[3], sample.life_chance, sample.predicted, sample.system_on);
+#else
+  sendDataToBrokerUDP(sample.temp, sample.hum, sample.gas, sample.lux, sample.life_chance, sample.predicted, sample.system_on, terrain_status, sample.tick_ms);
+#endif
 }
 
 
@@ -240,7 +432,7 @@ void IRAM_ATTR handleButtonInterrupt() {
   unsigned long currentTime = millis();
   if (currentTime - lastInterruptTime > 200) { 
     lastInterruptTime = currentTime;
-    buttonPressed = true;
+    buttonPressed.store(true);
   }
 }
 
@@ -271,16 +463,16 @@ void connectBrokerTCP() {
     return; // Já conectado
   }
 
-  Serial.printf("Conectando ao broker TCP em %s:%d...\n", BROKER_IP, BROKER_COMMAND_PORT);
+  LOG_INFO(LOG_MSG_BROKER_CONNECTING, BROKER_IP, BROKER_COMMAND_PORT);
   if (brokerClient.connect(BROKER_IP, BROKER_COMMAND_PORT)) {
-    Serial.println("Conectado ao broker TCP.");
+    LOG_INFO(LOG_MSG_BROKER_CONNECTED);
     String registerMsg = "{\"type\":\"register\",\"name\":\"";
     registerMsg += DEVICE_NAME;
     registerMsg += "\"}";
     brokerClient.print(registerMsg);
-    Serial.println("Registrado com o broker.");
+    LOG_INFO(LOG_MSG_BROKER_REGISTERED);
   } else {
-    Serial.println("Falha ao conectar ao broker TCP. Tentando novamente no próximo loop.");
+    LOG_WARN(LOG_MSG_BROKER_FAILED);
 
   }
 }
@@ -288,35 +480,111 @@ void connectBrokerTCP() {
 void handleBrokerCommands() {
   while (brokerClient.available()) {
     String line = brokerClient.readStringUntil('\n'); // Lê a mensagem até a quebra de linha
-    Serial.print("Comando recebido do broker: ");
-    Serial.println(line);
 
     // Parse do JSON do comando
     StaticJsonDocument<200> doc; // Tamanho do buffer JSON (ajuste conforme necessário)
     DeserializationError error = deserializeJson(doc, line);
 
     if (error) {
-      Serial.print(F("deserializeJson() falhou: "));
-      Serial.println(error.c_str());
+      LOG_WARN(LOG_MSG_COMMAND_PARSE_FAILED, error.c_str());  // c_str(): texto estático do ArduinoJson
       return;
     }
 
     if (doc.containsKey("command") && doc["command"].is<const char*>()) {
         const char* command_type = doc["command"].as<const char*>();
 
-        if (strcmp(command_type, "toggle_system_state") == 0) {
-            systemOn = !systemOn;
-            Serial.printf("Comando remoto: Sistema agora: %s\n", systemOn ? "Ligado" : "Desligado");
+        uint32_t command_id = doc["id"].as<uint32_t>(); // 0 se o broker não mandar id
+        uint32_t epoch = doc["epoch"].as<uint32_t>();    // Início do broker que numerou o comando
+        if (epoch != 0 && epoch != lastCommandEpoch) {
+            lastCommandEpoch = epoch;
+            lastCommandId = 0;  // Broker reiniciado: a numeração recomeçou
+            lastAppliedCommandId.store(0);
+        }
+
+        if (strcmp(command_type, "time_sync") == 0) {
+            // Respondido na hora (sem passar pela aquisição): o broker mede a ida e volta
+            sendTimeSyncToBroker(command_id);
+            LOG_DEBUG(LOG_MSG_TIME_SYNC, (unsigned long)command_id);
+        } else if (command_id != 0 && command_id <= lastCommandId) {
+            // Retransmissão de um comando já recebido: o ack anterior se perdeu ou atrasou
+            if (command_id <= lastAppliedCommandId.load()) {
+                LOG_INFO(LOG_MSG_COMMAND_REPEATED, (unsigned long)command_id);
+                sendAckToBroker(command_id, millis(), millis(), systemOn.load(), true);
+            } else {
+                // Ainda na fila da aquisição: o ack de verdade sai quando o toggle for aplicado
+                LOG_DEBUG(LOG_MSG_COMMAND_PENDING, (unsigned long)command_id);
+            }
+        } else if (strcmp(command_type, "toggle_system_state") == 0) {
+            LOG_INFO(LOG_MSG_COMMAND_RECEIVED, (unsigned long)command_id, "toggle_system_state");
+            // Aplicado pela tarefa de aquisição em até COMMAND_POLL_INTERVAL; o ack sai depois disso
+            PipelineCommand command = { PIPELINE_COMMAND_TOGGLE_SYSTEM, command_id, millis() };
+            if (spsc_push(&commandQueue, &command)) {
+                lastCommandId = command_id ? command_id : lastCommandId;
+            } else {
+                LOG_WARN(LOG_MSG_COMMAND_QUEUE_FULL);
+            }
         } else {
-            Serial.printf("Comando desconhecido: %s\n", command_type);
+            LOG_WARN(LOG_MSG_COMMAND_UNKNOWN, (unsigned long)command_id);
+            sendRejectToBroker(command_id, "unknown_command");  // O broker conclui na hora, sem retransmitir
         }
     } else {
-        Serial.println("Comando JSON inválido ou formato inesperado.");
+        LOG_WARN(LOG_MSG_COMMAND_INVALID);
     }
   }
 }
 
-void sendDataToBrokerUDP(float temp, float hum, float gas, float lux, float life_chance, bool system_on, const char* terrain_status) {
+// Confirma um comando ao broker com os instantes de recebimento e aplicação (millis() do ESP32)
+void sendAckToBroker(uint32_t id, unsigned long received_ms, unsigned long applied_ms, bool system_on, bool duplicate) {
+  if (id == 0 || !brokerClient.connected()) {
+    return;
+  }
+  StaticJsonDocument<200> doc;
+  char jsonBuffer[200];
+  doc["type"] = "ack";
+  doc["id"] = id;
+  doc["received_ms"] = received_ms;
+  doc["applied_ms"] = applied_ms;
+  doc["system_on"] = system_on;
+  doc["duplicate"] = duplicate;
+  serializeJson(doc, jsonBuffer);
+  brokerClient.print(jsonBuffer);
+  brokerClient.print("\n");
+}
+
+// Recusa um comando (nack): o broker o dá como concluído sem esperar pelas retransmissões
+void sendRejectToBroker(uint32_t id, const char* error) {
+  if (id == 0 || !brokerClient.connected()) {
+    return;
+  }
+  StaticJsonDocument<128> doc;
+  char jsonBuffer[128];
+  doc["type"] = "nack";
+  doc["id"] = id;
+  doc["error"] = error;
+  serializeJson(doc, jsonBuffer);
+  brokerClient.print(jsonBuffer);
+  brokerClient.print("\n");
+}
+
+// Responde um time_sync com o millis() atual; o broker estima o deslocamento do relógio pelo meio da ida e volta
+void sendTimeSyncToBroker(uint32_t id) {
+  if (!brokerClient.connected()) {
+    return;
+  }
+  char jsonBuffer[80];
+  snprintf(jsonBuffer, sizeof(jsonBuffer), "{\"type\":\"time_sync\",\"id\":%lu,\"device_ms\":%lu}\n",
+           (unsigned long)id, millis());
+  brokerClient.print(jsonBuffer);
+}
+
+// Instantes da amostra (millis() do ESP32) para o rastro de latência no broker
+static void addTraceToJson(JsonObject obj, unsigned long capture_ms) {
+  obj["seq"] = traceSequence++;
+  obj["capture_ms"] = capture_ms;
+  obj["send_ms"] = millis();
+}
+
+void sendDataToBrokerUDP(float temp, float hum, float gas, float lux, float life_chance, bool predicted, bool system_on, const char* terrain_status, unsigned long capture_ms) {
   WiFiUDP udp;
   char jsonBuffer[512]; 
 
@@ -330,8 +598,11 @@ void sendDataToBrokerUDP(float temp, float hum, float gas, float lux, float life
   data["gas"] = gas;
   data["lux"] = lux;
   data["life_chance"] = life_chance;
+  data["predicted"] = predicted;  // Sem predição neste ciclo life_chance vem 0
   data["terrain_status"] = terrain_status;
   data["system_on"] = system_on;
+  data["interval_ms"] = currentSampleInterval;
+  addTraceToJson(doc.createNestedObject("trace"), capture_ms);
   serializeJson(doc, jsonBuffer);
 
   udp.beginPacket(BROKER_IP, BROKER_DATA_PORT);
@@ -341,6 +612,132 @@ void sendDataToBrokerUDP(float temp, float hum, float gas, float lux, float life
 }
 
 
+// Modo de resumo: acumula a leitura na janela atual, envia o resumo quando a janela fecha e
+// envia leituras brutas (a anterior, a do cruzamento e as seguintes) quando a classificação muda
+void handleSummaryTelemetry(float temp, float hum, float gas, float lux, float life_chance, bool predicted, bool system_on, const char* terrain_status) {
+  static int lastTerrainClass = -1;
+  static int rawSamplesPending = 0;
+  static const char* lastTerrainStatus = "Desativado";
+
+  // Última leitura que não foi enviada em formato bruto (contexto "antes" do cruzamento)
+  static bool hasPrevious = false;
+  static float prevTemp, prevHum, prevGas, prevLux, prevChance;
+  static bool prevSystemOn, prevPredicted;
+  static const char* prevTerrainStatus;
+  static unsigned long prevCaptureTick;
+
+  summary.ticks++;
+  if (system_on) {
+    float readings[SUMMARY_CHANNELS] = { temp, hum, gas, lux };
+    summary_add_readings(&summary, readings);
+  } else {
+    lastTerrainStatus = "Desativado";
+  }
+
+  if (predicted) {
+    summary_add_life_chance(&summary, life_chance);
+    lastTerrainStatus = terrain_status;
+
+    int terrainClass = life_chance >= 0.70 ? 2 : (life_chance >= 0.5 ? 1 : 0);
+    if (lastTerrainClass >= 0 && terrainClass != lastTerrainClass) {
+      if (hasPrevious) {
+        sendDataToBrokerUDP(prevTemp, prevHum, prevGas, prevLux, prevChance, prevPredicted, prevSystemOn, prevTerrainStatus, prevCaptureTick);
+      }
+      rawSamplesPending = RAW_SAMPLES_AFTER_CROSSING + 1; // Inclui a própria leitura do cruzamento
+    }
+    lastTerrainClass = terrainClass;
+  }
+
+  if (rawSamplesPending > 0) {
+    sendDataToBrokerUDP(temp, hum, gas, lux, life_chance, predicted, system_on, terrain_status, currentCaptureTick);
+    rawSamplesPending--;
+    hasPrevious = false;
+  } else {
+    hasPrevious = true;
+    prevTemp = temp; prevHum = hum; prevGas = gas; prevLux = lux; prevChance = life_chance;
+    prevSystemOn = system_on;
+    prevPredicted = predicted;
+    prevTerrainStatus = terrain_status;
+    prevCaptureTick = currentCaptureTick;
+  }
+
+  if (summary.ticks >= SUMMARY_WINDOW_SAMPLES || millis() - summary.started_ms >= SUMMARY_WINDOW_MAX_MS) {
+    sendSummaryToBrokerUDP(system_on, predicted, lastTerrainStatus);
+    summary_reset(&summary, millis());
+  }
+}
+
+static void addStatsToJson(JsonObject obj, const RunningStats* stats) {
+  obj["min"] = stats->min;
+  obj["max"] = stats->max;
+  obj["mean"] = stats->mean;
+  obj["var"] = stats_variance(stats);
+  obj["last"] = stats->last;
+}
+
+void sendSummaryToBrokerUDP(bool system_on, bool predicted, const char* terrain_status) {
+  static const char* channelNames[SUMMARY_CHANNELS] = { "temp", "hum", "gas", "lux" };
+  WiFiUDP udp;
+  char jsonBuffer[1024];
+
+  StaticJsonDocument<1024> doc;  // ~45 membros (16 bytes cada no ESP32) com o rastro
+  doc["source"] = DEVICE_NAME;
+  doc["type"] = "sensor_summary";
+  doc["window_ms"] = millis() - summary.started_ms;
+
+  JsonObject data = doc.createNestedObject("data");
+  data["count"] = summary.channels[0].count;
+  for (int c = 0; c < SUMMARY_CHANNELS; ++c) {
+    addStatsToJson(data.createNestedObject(channelNames[c]), &summary.channels[c]);
+  }
+  JsonObject life = data.createNestedObject("life_chance");
+  life["count"] = summary.life_chance.count;
+  life["max"] = summary.life_chance.max;
+  life["mean"] = summary.life_chance.mean;
+  life["last"] = summary.life_chance.last;
+  data["terrain_status"] = terrain_status;
+  data["system_on"] = system_on;
+  data["predicted"] = predicted;  // life_chance.last é da mesma leitura que os 'last' dos canais
+  data["interval_ms"] = currentSampleInterval;
+  addTraceToJson(doc.createNestedObject("trace"), currentCaptureTick);  // Última leitura da janela
+  serializeJson(doc, jsonBuffer);
+
+  udp.beginPacket(BROKER_IP, BROKER_DATA_PORT);
+  udp.print(jsonBuffer);
+  udp.endPacket();
+}
+
+// Modo codec: envia os códigos do ADC e a chance de vida quantizada num quadro binário
+void sendCompressedToBrokerUDP(int rawTemp, int rawHum, int rawGas, int rawLux, float life_chance, bool predicted, bool system_on) {
+  WiFiUDP udp;
+  uint8_t frame[CODEC_MAX_FRAME];
+  CodecSample sample;
+
+  sample.values[0] = rawTemp;
+  sample.values[1] = rawHum;
+  sample.values[2] = rawGas;
+  sample.values[3] = rawLux;
+  sample.values[CODEC_CHANNEL_LIFE] = codec_quantize(life_chance, 1.0f, CODEC_LIFE_SCALE);
+  sample.flags = (system_on ? CODEC_FLAG_SYSTEM_ON : 0) | (predicted ? CODEC_FLAG_PREDICTED : 0)
+      | (codec_rate_code(currentSampleInterval) << CODEC_RATE_SHIFT);
+  if (predicted) {
+    sample.flags |= codec_terrain_class(system_on, life_chance) << CODEC_TERRAIN_SHIFT;
+  }
+  sample.flags |= CODEC_FLAG_TRACE;
+  sample.capture_ms = currentCaptureTick;
+  sample.send_ms = millis();
+
+  size_t length = codec_encode(&codecEncoder, DEVICE_NAME, &sample, frame, sizeof(frame));
+  if (length == 0) {
+    LOG_ERROR(LOG_MSG_CODEC_FAILED);
+    return;
+  }
+
+  udp.beginPacket(BROKER_IP, BROKER_DATA_PORT);
+  udp.write(frame, length);
+  udp.endPacket();
+}
+
 
 void handleTelegramMessages() {
   int numNewMessages = bot.getUpdates(bot.last_message_received + 1);
@@ -361,7 +758,7 @@ void handleTelegramMessages() {
           "Markdown");
       }
       else if (text == "/status") {
-        String status = systemOn ? "🟢 *Sistema:* Ligado" : "🔴 *Sistema:* Desligado";
+        String status = systemOn.load() ? "🟢 *Sistema:* Ligado" : "🔴 *Sistema:* Desligado";
         String wifiStatus = WiFi.status() == WL_CONNECTED
           ? "📶 *Wi-Fi:* Conectado\\n🌐 *IP:* " + WiFi.localIP().toString()
           : "📶 *Wi-Fi:* Desconectado";
@@ -372,15 +769,15 @@ void handleTelegramMessages() {
           "Markdown");
       }
       else if (text == "/sensores") {
-        int rawTemp = analogRead(ADC1_0);
-        int rawHum  = analogRead(ADC1_3);
-        int rawGas  = analogRead(ADC1_6);
-        int rawLux  = analogRead(ADC1_7);
-
-        float temp = ((float)rawTemp / 4095.0f) * MAX_TEMPERATURE_C;
-        float hum  = ((float)rawHum / 4095.0f) * 100.0f;
-        float gas  = ((float)rawGas / 4095.0f) * MAX_GAS_PPM;
-        float lux  = ((float)rawLux / 4095.0f) * MAX_LIGHT_CD;
+        // O ADC pertence à tarefa de aquisição: usa a última amostra que chegou pelo pipeline
+        if (!hasLatestSample) {
+          bot.sendMessage(chat_id, "⏳ Aguardando a primeira leitura dos sensores.", "Markdown");
+          continue;
+        }
+        float temp = latestSample.temp;
+        float hum  = latestSample.hum;
+        float gas  = latestSample.gas;
+        float lux  = latestSample.lux;
 
         float input[INPUT_SIZE] = { temp, hum, gas, lux };
         normalize_readings(input);
@@ -448,9 +845,9 @@ void sendTelegramLifeMessage(float temp, float hum, float gas, float lux, float
 
       if (bot.messages[0].chat_id.length() > 0) { 
           bot.sendMessage(bot.messages[0].chat_id, message, "Markdown");
-          Serial.println("Mensagem de 'Propício à vida' enviada via Telegram!");
+          LOG_INFO(LOG_MSG_TELEGRAM_SENT);
       } else {
-          Serial.println("Nenhum chat ID conhecido para enviar a mensagem automática do Telegram.");
+          LOG_WARN(LOG_MSG_TELEGRAM_NO_CHAT);
       }
     }
   } else {
@@ -465,10 +862,10 @@ void sendTakePhotoCommandToBroker() {
     if (brokerClient.connected()) {
       String commandMsg = "{\"type\":\"command\",\"command_type\":\"take_photo\"}";
       brokerClient.print(commandMsg);
-      Serial.println("Comando 'take_photo' enviado ao broker.");
+      LOG_INFO(LOG_MSG_PHOTO_SENT);
       lastPhotoCommandSent = currentTime; 
     } else {
-      Serial.println("Não foi possível enviar comando 'take_photo': Broker não conectado.");
+      LOG_WARN(LOG_MSG_PHOTO_OFFLINE);
     }
   }
 }
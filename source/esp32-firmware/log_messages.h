@@ -0,0 +1,56 @@
+/*
+* Tabela das mensagens de log do firmware (async_log.h).
+*
+* Cada mensagem tem um id e um formato printf; o registro no anel guarda só o id e os argumentos,
+* e o texto é montado depois pela tarefa de log. No modo binário só o id vai pela serial, então o
+* decodificador do host (source/host/log_decode.c) precisa desta mesma tabela: novas mensagens
+* entram sempre no fim, para os ids antigos continuarem valendo.
+*
+* Argumentos %s devem apontar para strings estáticas (literais), pois são lidos só na formatação.
+*/
+
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+#define LOG_MESSAGES(X) \
+    X(LOG_MSG_SEPARATOR,          "============================================") \
+    X(LOG_MSG_TOGGLE,             "%s: Sistema agora: %s") \
+    X(LOG_MSG_TEMPERATURE,        "Temperatura: %.2f °C") \
+    X(LOG_MSG_HUMIDITY,           "Umidade: %.2f %%") \
+    X(LOG_MSG_GAS,                "Gás: %.2f ppm") \
+    X(LOG_MSG_LIGHT,              "Luminosidade: %.2f cd") \
+    X(LOG_MSG_INTERVAL,           "Intervalo de leitura: %lu ms%s") \
+    X(LOG_MSG_LIFE_CHANCE,        "Chance de vida: %.2f%%") \
+    X(LOG_MSG_PLANET_STATUS,      "Status do planeta: %s") \
+    X(LOG_MSG_SENSORS_OFF,        "Sensores e IA desativados.") \
+    X(LOG_MSG_WIFI_STATUS,        "Status Wi-Fi: %s") \
+    X(LOG_MSG_SYSTEM_STATUS,      "Status do Sistema: %s") \
+    X(LOG_MSG_WIFI_LOST,          "Wi-Fi desconectado. Tentando reconectar...") \
+    X(LOG_MSG_BROKER_LOST,        "Conexão TCP com broker perdida. Tentando reconectar...") \
+    X(LOG_MSG_BROKER_CONNECTING,  "Conectando ao broker TCP em %s:%d...") \
+    X(LOG_MSG_BROKER_CONNECTED,   "Conectado ao broker TCP.") \
+    X(LOG_MSG_BROKER_REGISTERED,  "Registrado com o broker.") \
+    X(LOG_MSG_BROKER_FAILED,      "Falha ao conectar ao broker TCP. Tentando novamente no próximo loop.") \
+    X(LOG_MSG_COMMAND_REPEATED,   "Comando %u repetido, confirmando de novo.") \
+    X(LOG_MSG_COMMAND_QUEUE_FULL, "Fila de comandos cheia: toggle_system_state descartado.") \
+    X(LOG_MSG_COMMAND_INVALID,    "Comando JSON inválido ou formato inesperado.") \
+    X(LOG_MSG_CODEC_FAILED,       "Falha ao codificar a leitura para o broker.") \
+    X(LOG_MSG_TELEGRAM_SENT,      "Mensagem de 'Propício à vida' enviada via Telegram!") \
+    X(LOG_MSG_TELEGRAM_NO_CHAT,   "Nenhum chat ID conhecido para enviar a mensagem automática do Telegram.") \
+    X(LOG_MSG_PHOTO_SENT,         "Comando 'take_photo' enviado ao broker.") \
+    X(LOG_MSG_PHOTO_OFFLINE,      "Não foi possível enviar comando 'take_photo': Broker não conectado.") \
+    X(LOG_MSG_DROPPED,            "[log] %u registros descartados (anel cheio)") \
+    X(LOG_MSG_COMMAND_RECEIVED,   "Comando %u recebido do broker: %s") \
+    X(LOG_MSG_TIME_SYNC,          "time_sync %u respondido.") \
+    X(LOG_MSG_COMMAND_PARSE_FAILED, "deserializeJson() falhou: %s") \
+    X(LOG_MSG_COMMAND_UNKNOWN,    "Comando %u desconhecido: recusado (nack).") \
+    X(LOG_MSG_COMMAND_PENDING,    "Comando %u repetido ainda na fila: aguardando a aplicação.")
+
+#define LOG_MESSAGE_ENUM(id, format) id,
+
+typedef enum {
+    LOG_MESSAGES(LOG_MESSAGE_ENUM)
+    LOG_MESSAGE_COUNT
+} LogMessageId;
+
+#endif // LOG_MESSAGES_H
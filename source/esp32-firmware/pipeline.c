@@ -0,0 +1,60 @@
+#include "pipeline.h"
+
+#include <string.h>
+
+#include "ia_model.h"
+#include "ia_model_gen.h"
+#include "telemetry_codec.h"
+
+
+void pipeline_acquisition_init(AcquisitionState *state, const RateConfig *rate_config, unsigned long prediction_interval_ms) {
+    features_init(&state->features);
+    rate_init(&state->rate, rate_config);
+    state->prediction_interval_ms = prediction_interval_ms;
+    state->last_prediction_ms = 0;
+}
+
+/* Um ciclo de aquisição: converte os códigos do ADC, alimenta as janelas e, no intervalo
+* da IA, roda a predição; por fim o controle de taxa decide quando será o próximo ciclo.
+* Com o sistema desligado a amostra sai zerada e o intervalo não muda. */
+void pipeline_acquire(AcquisitionState *state, const int32_t raw[PIPELINE_CHANNELS], int system_on,
+                      unsigned long now_ms, PipelineSample *sample) {
+    memset(sample, 0, sizeof(*sample));
+    sample->tick_ms = now_ms;
+    sample->system_on = system_on ? 1 : 0;
+    sample->interval_ms = state->rate.interval_ms;
+    if (!system_on) {
+        return;
+    }
+
+    memcpy(sample->raw, raw, sizeof(sample->raw));
+    // Converte leituras ADC (0-4095) para valores reais com base nos MAX_ definidos
+    sample->temp = ((float)raw[0] / 4095.0f) * MAX_TEMPERATURE_READING;
+    sample->hum  = ((float)raw[1] / 4095.0f) * 100.0f;
+    sample->gas  = ((float)raw[2] / 4095.0f) * MAX_GAS_READING;
+    sample->lux  = ((float)raw[3] / 4095.0f) * MAX_LIGHT_READING;
+
+    const float reading[INPUT_SIZE] = { sample->temp, sample->hum, sample->gas, sample->lux };
+    float input[INPUT_SIZE] = { sample->temp, sample->hum, sample->gas, sample->lux };
+    normalize_readings(input);
+    features_push_at(&state->features, input, now_ms);   // Grade fixa: não segue o intervalo adaptativo
+
+    int burst = rate_observe(&state->rate, input);
+    if (burst || now_ms - state->last_prediction_ms >= rate_prediction_interval(&state->rate, state->prediction_interval_ms)) {
+        state->last_prediction_ms = now_ms;
+        // Versão especializada (gen_model.py): normalização dobrada nos pesos, mesma saída de model_predict_ext
+#if IA_MODEL_GEN_USES_FEATURES
+        float feature_vector[FEATURE_SIZE];
+        features_extract(&state->features, feature_vector);
+        sample->life_chance = model_predict_generated(reading, feature_vector);
+#else
+        // Pesos das características ainda zerados: as janelas seguem alimentadas, sem extração
+        sample->life_chance = model_predict_generated(reading, NULL);
+#endif
+        sample->predicted = 1;
+        sample->terrain_class = codec_terrain_class(1, sample->life_chance);
+    }
+
+    sample->interval_ms = rate_update(&state->rate, sample->life_chance, sample->predicted);
+    sample->rate_active = state->rate.active;
+}
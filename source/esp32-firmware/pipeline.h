@@ -0,0 +1,82 @@
+/*
+* Pipeline de aquisição entre os dois núcleos do ESP32.
+*
+* A tarefa de tempo real (núcleo 1) lê o ADC, alimenta as janelas de características e roda a IA;
+* cada ciclo vira um PipelineSample enviado por uma fila SPSC para a tarefa de rede (núcleo 0),
+* que cuida de telemetria, comandos do broker e Telegram. Comandos do broker voltam por uma
+* segunda fila SPSC e a confirmação (ack) de cada comando aplicado segue por uma terceira.
+* O intervalo entre ciclos é decidido pelo controle adaptativo de taxa (adaptive_rate.h).
+* O mesmo código roda no host com pthreads (source/host/pipeline_host.c).
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+
+#include "adaptive_rate.h"
+#include "ia_features.h"
+#include "spsc_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIPELINE_CHANNELS 4
+#define PIPELINE_SAMPLE_QUEUE_SIZE 16     // 16 x 0,5s = 8s de folga se a rede travar (potência de 2)
+#define PIPELINE_COMMAND_QUEUE_SIZE 8
+#define PIPELINE_ACK_QUEUE_SIZE 8
+
+/* Eventos ocorridos no ciclo da amostra */
+#define PIPELINE_EVENT_BUTTON_TOGGLE 0x01
+#define PIPELINE_EVENT_REMOTE_TOGGLE 0x02
+
+/* Comandos da tarefa de rede para a de aquisição */
+#define PIPELINE_COMMAND_TOGGLE_SYSTEM 1
+
+/* Resultado de um ciclo de aquisição */
+typedef struct {
+    unsigned long tick_ms;
+    int32_t raw[PIPELINE_CHANNELS];   // Códigos do ADC
+    float temp, hum, gas, lux;
+    float life_chance;
+    uint8_t system_on;
+    uint8_t predicted;                // A IA rodou neste ciclo
+    uint8_t terrain_class;            // CODEC_TERRAIN_* (telemetry_codec.h)
+    uint8_t events;                   // PIPELINE_EVENT_*
+    uint8_t rate_active;              // Controle de taxa em modo ativo
+    uint32_t interval_ms;             // Intervalo até o próximo ciclo
+} PipelineSample;
+
+typedef struct {
+    uint8_t type;
+    uint32_t id;                      // Id do comando no broker (0 se não houver)
+    unsigned long received_ms;        // millis() quando a tarefa de rede recebeu o comando
+} PipelineCommand;
+
+/* Confirmação de um comando aplicado, da tarefa de aquisição para a de rede */
+typedef struct {
+    uint32_t id;
+    unsigned long received_ms;
+    unsigned long applied_ms;
+    uint8_t system_on;                // Estado resultante
+} PipelineAck;
+
+/* Estado da tarefa de aquisição */
+typedef struct {
+    FeatureState features;
+    RateController rate;
+    unsigned long prediction_interval_ms;   // Intervalo da IA no intervalo de amostragem base
+    unsigned long last_prediction_ms;
+} AcquisitionState;
+
+/* Prototipo de funções*/
+void pipeline_acquisition_init(AcquisitionState *state, const RateConfig *rate_config, unsigned long prediction_interval_ms);
+void pipeline_acquire(AcquisitionState *state, const int32_t raw[PIPELINE_CHANNELS], int system_on,
+                      unsigned long now_ms, PipelineSample *sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIPELINE_H
@@ -0,0 +1,67 @@
+/*
+* Fila circular sem trava para um produtor e um consumidor (SPSC).
+*
+* Usada para ligar as tarefas dos dois núcleos do ESP32 (e as threads do build de host):
+* só o produtor escreve 'head' e só o consumidor escreve 'tail', então basta publicar
+* cada índice com semântica release e lê-lo do outro lado com acquire. Os elementos são
+* copiados para um buffer estático fornecido pelo chamador, com capacidade potência de 2.
+*
+* Usa os builtins __atomic do GCC para funcionar igual em C (host e .c do sketch) e em C++ (.ino).
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t *buffer;
+    uint32_t element_size;
+    uint32_t mask;          // Capacidade - 1
+    uint32_t head;          // Próxima escrita (só o produtor altera)
+    uint32_t tail;          // Próxima leitura (só o consumidor altera)
+    uint32_t dropped;       // Pushes recusados com a fila cheia (só o produtor altera)
+} SpscQueue;
+
+/* 'capacity' deve ser potência de 2 e 'buffer' ter capacity * element_size bytes */
+static inline void spsc_init(SpscQueue *queue, void *buffer, uint32_t element_size, uint32_t capacity) {
+    queue->buffer = (uint8_t *)buffer;
+    queue->element_size = element_size;
+    queue->mask = capacity - 1;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->dropped = 0;
+}
+
+/* Lado do produtor. Retorna 0 (e conta o descarte) se a fila estiver cheia. */
+static inline int spsc_push(SpscQueue *queue, const void *element) {
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head - tail > queue->mask) {
+        __atomic_store_n(&queue->dropped, queue->dropped + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    memcpy(queue->buffer + (head & queue->mask) * queue->element_size, element, queue->element_size);
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Lado do consumidor. Retorna 0 se a fila estiver vazia. */
+static inline int spsc_pop(SpscQueue *queue, void *element) {
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return 0;
+    }
+    memcpy(element, queue->buffer + (tail & queue->mask) * queue->element_size, queue->element_size);
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Ocupação aproximada (exata quando chamada por um dos dois lados) */
+static inline uint32_t spsc_size(const SpscQueue *queue) {
+    return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,197 @@
+#include "telemetry_codec.h"
+
+#include <string.h>
+
+
+/* Zig-zag: mapeia inteiros com sinal em sem sinal (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) */
+static uint32_t zigzag_encode(int32_t x) {
+    return ((uint32_t)x << 1) ^ (uint32_t)(x >> 31);
+}
+
+static int32_t zigzag_decode(uint32_t x) {
+    return (int32_t)(x >> 1) ^ -(int32_t)(x & 1);
+}
+
+/* Varint LEB128: 7 bits por byte, bit 7 indica que há mais bytes. Retorna 0 se não couber. */
+static size_t varint_write(uint32_t x, uint8_t *out, size_t capacity) {
+    size_t n = 0;
+    do {
+        if (n >= capacity) {
+            return 0;
+        }
+        uint8_t byte = x & 0x7F;
+        x >>= 7;
+        out[n++] = x ? (byte | 0x80) : byte;
+    } while (x);
+    return n;
+}
+
+/* Retorna os bytes consumidos, ou 0 se o varint estiver truncado ou longo demais */
+static size_t varint_read(const uint8_t *in, size_t length, uint32_t *x) {
+    uint32_t value = 0;
+    for (size_t n = 0; n < length && n < 5; ++n) {
+        value |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) {
+            *x = value;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/* Converte um valor físico de volta para o código inteiro em [0, full_scale] */
+int32_t codec_quantize(float value, float max_value, int32_t full_scale) {
+    float scaled = value / max_value * (float)full_scale + 0.5f;
+    if (scaled < 0.0f) return 0;
+    if (scaled > (float)full_scale) return full_scale;
+    return (int32_t)scaled;
+}
+
+/* Mesmos limiares do loop(): 0.70 propício, 0.5 moderado */
+uint8_t codec_terrain_class(int system_on, float life_chance) {
+    if (!system_on) return CODEC_TERRAIN_DISABLED;
+    if (life_chance >= 0.70f) return CODEC_TERRAIN_FAVORABLE;
+    if (life_chance >= 0.5f) return CODEC_TERRAIN_MODERATE;
+    return CODEC_TERRAIN_HOSTILE;
+}
+
+/* Menor potência de 2 vezes CODEC_RATE_UNIT_MS que cobre o intervalo (até 8s) */
+uint8_t codec_rate_code(unsigned long interval_ms) {
+    uint8_t code = 1;
+    while (code < 7 && ((unsigned long)CODEC_RATE_UNIT_MS << (code - 1)) < interval_ms) {
+        code++;
+    }
+    return code;
+}
+
+unsigned long codec_rate_interval(uint8_t code) {
+    return code ? (unsigned long)CODEC_RATE_UNIT_MS << (code - 1) : 0;
+}
+
+void codec_encoder_init(CodecEncoder *encoder) {
+    memset(encoder, 0, sizeof(*encoder));
+}
+
+size_t codec_encode(CodecEncoder *encoder, const char *name, const CodecSample *sample,
+                    uint8_t *out, size_t capacity) {
+    int keyframe = !encoder->has_previous || (encoder->seq % CODEC_KEYFRAME_INTERVAL) == 0;
+    size_t n = 0;
+    size_t written;
+
+    if (capacity < 3) {
+        return 0;
+    }
+    out[n++] = keyframe ? CODEC_FRAME_KEY : CODEC_FRAME_DELTA;
+    out[n++] = encoder->seq;
+
+    if (keyframe) {
+        size_t name_length = strlen(name);
+        if (name_length > CODEC_MAX_NAME) name_length = CODEC_MAX_NAME;
+        if (n + 1 + name_length + 1 > capacity) {
+            return 0;
+        }
+        out[n++] = (uint8_t)name_length;
+        memcpy(out + n, name, name_length);
+        n += name_length;
+    }
+    out[n++] = sample->flags;
+
+    for (int c = 0; c < CODEC_CHANNELS; ++c) {
+        uint32_t word = keyframe
+            ? (uint32_t)sample->values[c]
+            : zigzag_encode(sample->values[c] - encoder->previous[c]);
+        written = varint_write(word, out + n, capacity - n);
+        if (!written) {
+            return 0;
+        }
+        n += written;
+    }
+
+    if (sample->flags & CODEC_FLAG_TRACE) {
+        uint32_t trace[2] = {
+            keyframe ? sample->send_ms : sample->send_ms - encoder->previous_send_ms,
+            sample->send_ms - sample->capture_ms
+        };
+        for (int t = 0; t < 2; ++t) {
+            written = varint_write(trace[t], out + n, capacity - n);
+            if (!written) {
+                return 0;
+            }
+            n += written;
+        }
+        encoder->previous_send_ms = sample->send_ms;
+    }
+
+    memcpy(encoder->previous, sample->values, sizeof(encoder->previous));
+    encoder->has_previous = 1;
+    encoder->seq++;
+    return n;
+}
+
+void codec_decoder_init(CodecDecoder *decoder) {
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+/* Retorna 1 se uma leitura foi decodificada, 0 se o quadro foi descartado por
+* perda de sincronia (aguardando quadro chave) e -1 se o quadro for inválido. */
+int codec_decode(CodecDecoder *decoder, const uint8_t *in, size_t length, CodecSample *sample) {
+    size_t n = 0;
+    size_t consumed;
+    uint32_t word;
+
+    if (length < 3) {
+        return -1;
+    }
+    uint8_t type = in[n++];
+    uint8_t seq = in[n++];
+
+    if (type == CODEC_FRAME_KEY) {
+        size_t name_length = in[n++];
+        if (name_length > CODEC_MAX_NAME || n + name_length + 1 > length) {
+            return -1;
+        }
+        memcpy(decoder->name, in + n, name_length);
+        decoder->name[name_length] = '\0';
+        n += name_length;
+    } else if (type == CODEC_FRAME_DELTA) {
+        if (!decoder->synced || seq != (uint8_t)(decoder->seq + 1)) {
+            decoder->synced = 0;
+            return 0;
+        }
+    } else {
+        return -1;
+    }
+
+    sample->flags = in[n++];
+    for (int c = 0; c < CODEC_CHANNELS; ++c) {
+        consumed = varint_read(in + n, length - n, &word);
+        if (!consumed) {
+            decoder->synced = 0;
+            return -1;
+        }
+        n += consumed;
+        sample->values[c] = type == CODEC_FRAME_KEY
+            ? (int32_t)word
+            : decoder->previous[c] + zigzag_decode(word);
+    }
+
+    if (sample->flags & CODEC_FLAG_TRACE) {
+        uint32_t trace[2];
+        for (int t = 0; t < 2; ++t) {
+            consumed = varint_read(in + n, length - n, &trace[t]);
+            if (!consumed) {
+                decoder->synced = 0;
+                return -1;
+            }
+            n += consumed;
+        }
+        sample->send_ms = type == CODEC_FRAME_KEY ? trace[0] : decoder->previous_send_ms + trace[0];
+        sample->capture_ms = sample->send_ms - trace[1];
+        decoder->previous_send_ms = sample->send_ms;
+    }
+
+    memcpy(decoder->previous, sample->values, sizeof(decoder->previous));
+    decoder->seq = seq;
+    decoder->synced = 1;
+    return 1;
+}
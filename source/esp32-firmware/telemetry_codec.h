@@ -0,0 +1,97 @@
+/*
+* Codec binário da telemetria ESP32 -> broker (delta + varint).
+*
+* Cada leitura vira um quadro UDP pequeno no lugar do JSON em texto:
+* - os sensores são enviados como o código bruto do ADC (12 bits), que é a resolução real
+*   da medida; o broker reconstrói o valor físico com os mesmos MAX_* do firmware;
+* - a chance de vida é quantizada em passos de 1/CODEC_LIFE_SCALE;
+* - quadros delta carregam a diferença para a leitura anterior em zig-zag + varint
+*   (diferenças pequenas ocupam 1 byte);
+* - a cada CODEC_KEYFRAME_INTERVAL quadros é enviado um quadro chave com os valores
+*   absolutos e o nome do dispositivo, para o decodificador se recuperar de perdas.
+*
+* Formato dos quadros:
+*   chave: [CODEC_FRAME_KEY][seq][tam. nome][nome...][flags][varint x CODEC_CHANNELS]
+*   delta: [CODEC_FRAME_DELTA][seq][flags][zig-zag varint x CODEC_CHANNELS]
+* 'seq' é um contador de 8 bits; um salto na sequência invalida os deltas até o próximo quadro chave.
+* Com CODEC_FLAG_TRACE o quadro termina com o rastro da amostra (millis() do ESP32):
+*   [varint envio][varint envio - captura]; o envio é absoluto no quadro chave e, nos deltas,
+*   a diferença para o envio do quadro rastreado anterior (~2 bytes a 2 Hz).
+*/
+
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CODEC_CHANNELS 5            // Temperatura, umidade, gás, luz (códigos ADC) e chance de vida
+#define CODEC_CHANNEL_LIFE 4
+#define CODEC_ADC_FULL_SCALE 4095   // ADC de 12 bits do ESP32
+#define CODEC_LIFE_SCALE 10000      // Chance de vida com 4 casas (0,01%)
+
+#define CODEC_FRAME_KEY 0xF1
+#define CODEC_FRAME_DELTA 0xF2
+#define CODEC_KEYFRAME_INTERVAL 20  // 20 x 0,5s = um quadro chave a cada 10s
+#define CODEC_MAX_NAME 32
+#define CODEC_MAX_FRAME 80
+
+/* Flags de cada leitura */
+#define CODEC_FLAG_SYSTEM_ON 0x01
+#define CODEC_FLAG_PREDICTED 0x02       // A IA rodou neste ciclo
+#define CODEC_TERRAIN_SHIFT 2           // Bits 2-3: classe do terreno
+#define CODEC_TERRAIN_MASK 0x0C
+#define CODEC_TERRAIN_DISABLED 0
+#define CODEC_TERRAIN_HOSTILE 1
+#define CODEC_TERRAIN_MODERATE 2
+#define CODEC_TERRAIN_FAVORABLE 3
+#define CODEC_RATE_SHIFT 4              // Bits 4-6: intervalo de amostragem, CODEC_RATE_UNIT_MS << (código - 1)
+#define CODEC_RATE_MASK 0x70            // (código 0: não informado)
+#define CODEC_RATE_UNIT_MS 125
+#define CODEC_FLAG_TRACE 0x80           // Quadro com os instantes de captura e envio
+
+/* Uma leitura já quantizada */
+typedef struct {
+    int32_t values[CODEC_CHANNELS];
+    uint8_t flags;
+    uint32_t capture_ms;            // Só com CODEC_FLAG_TRACE
+    uint32_t send_ms;
+} CodecSample;
+
+typedef struct {
+    uint8_t seq;
+    int has_previous;
+    int32_t previous[CODEC_CHANNELS];
+    uint32_t previous_send_ms;
+} CodecEncoder;
+
+typedef struct {
+    uint8_t seq;
+    int synced;                     // 0 até receber um quadro chave
+    int32_t previous[CODEC_CHANNELS];
+    uint32_t previous_send_ms;
+    char name[CODEC_MAX_NAME + 1];
+} CodecDecoder;
+
+/* Prototipo de funções*/
+int32_t codec_quantize(float value, float max_value, int32_t full_scale);
+uint8_t codec_terrain_class(int system_on, float life_chance);
+uint8_t codec_rate_code(unsigned long interval_ms);
+unsigned long codec_rate_interval(uint8_t code);
+
+void codec_encoder_init(CodecEncoder *encoder);
+size_t codec_encode(CodecEncoder *encoder, const char *name, const CodecSample *sample,
+                    uint8_t *out, size_t capacity);
+
+void codec_decoder_init(CodecDecoder *decoder);
+int codec_decode(CodecDecoder *decoder, const uint8_t *in, size_t length, CodecSample *sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_CODEC_H
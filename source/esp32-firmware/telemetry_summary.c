@@ -0,0 +1,51 @@
+#include "telemetry_summary.h"
+
+
+void stats_reset(RunningStats *stats) {
+    stats->count = 0;
+    stats->min = 0.0f;
+    stats->max = 0.0f;
+    stats->mean = 0.0f;
+    stats->m2 = 0.0f;
+    stats->last = 0.0f;
+}
+
+void stats_add(RunningStats *stats, float x) {
+    stats->count++;
+    if (stats->count == 1) {
+        stats->min = x;
+        stats->max = x;
+    } else {
+        if (x < stats->min) stats->min = x;
+        if (x > stats->max) stats->max = x;
+    }
+    // Welford: atualiza a média e acumula o desvio com a média antiga e a nova
+    float delta = x - stats->mean;
+    stats->mean += delta / (float)stats->count;
+    stats->m2 += delta * (x - stats->mean);
+    stats->last = x;
+}
+
+/* Variância populacional da janela */
+float stats_variance(const RunningStats *stats) {
+    return stats->count > 1 ? stats->m2 / (float)stats->count : 0.0f;
+}
+
+void summary_reset(TelemetrySummary *summary, unsigned long now_ms) {
+    for (int c = 0; c < SUMMARY_CHANNELS; ++c) {
+        stats_reset(&summary->channels[c]);
+    }
+    stats_reset(&summary->life_chance);
+    summary->ticks = 0;
+    summary->started_ms = now_ms;
+}
+
+void summary_add_readings(TelemetrySummary *summary, const float x[SUMMARY_CHANNELS]) {
+    for (int c = 0; c < SUMMARY_CHANNELS; ++c) {
+        stats_add(&summary->channels[c], x[c]);
+    }
+}
+
+void summary_add_life_chance(TelemetrySummary *summary, float life_chance) {
+    stats_add(&summary->life_chance, life_chance);
+}
@@ -0,0 +1,50 @@
+/*
+* Resumo estatístico da telemetria por janela.
+*
+* No modo de telemetria por resumo o ESP32 não envia cada leitura ao broker: ele acumula,
+* para cada canal, contagem, mínimo, máximo, média, variância e último valor ao longo de
+* uma janela e envia um único pacote no fim dela. Média e variância usam o método de
+* Welford, que é numericamente estável e atualiza em O(1) sem guardar as amostras.
+*/
+
+#ifndef TELEMETRY_SUMMARY_H
+#define TELEMETRY_SUMMARY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SUMMARY_CHANNELS 4   // Temperatura, umidade, gás e luz
+
+/* Estatísticas acumuladas de um canal (método de Welford) */
+typedef struct {
+    unsigned long count;
+    float min;
+    float max;
+    float mean;
+    float m2;       // Soma dos quadrados dos desvios em relação à média
+    float last;
+} RunningStats;
+
+/* Resumo de uma janela de telemetria */
+typedef struct {
+    RunningStats channels[SUMMARY_CHANNELS];
+    RunningStats life_chance;   // Só recebe amostras dos ciclos em que a IA rodou
+    unsigned long ticks;        // Ciclos de leitura na janela (inclusive com o sistema desligado)
+    unsigned long started_ms;   // millis() no início da janela
+} TelemetrySummary;
+
+/* Prototipo de funções*/
+void stats_reset(RunningStats *stats);
+void stats_add(RunningStats *stats, float x);
+float stats_variance(const RunningStats *stats);
+
+void summary_reset(TelemetrySummary *summary, unsigned long now_ms);
+void summary_add_readings(TelemetrySummary *summary, const float x[SUMMARY_CHANNELS]);
+void summary_add_life_chance(TelemetrySummary *summary, float life_chance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_SUMMARY_H
@@ -0,0 +1,255 @@
+/*
+* Consulta nos segmentos do arquivo colunar de sensor_data (ver sensor_archive.h).
+*
+* Filtra por intervalo de tempo, dispositivo e faixa de chance de vida. Os zone maps do diretório
+* descartam os blocos que não podem ter linhas; dos blocos restantes só as colunas usadas são
+* expandidas. Imprime as linhas encontradas, as médias dos canais e quantos blocos foram lidos.
+* Com --export grava as leituras encontradas (float32 temperatura, umidade, gás, luz por linha) no
+* formato '-f bin' do score_history, para reavaliar o histórico arquivado com o modelo atual.
+* --full ignora os zone maps (mesmo resultado, para comparar o tempo).
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O2 -o archive_scan archive_scan.c sensor_archive.c -lz -lm
+*   ./archive_scan [--from s] [--to s] [--device nome] [--life-min p] [--life-max p] \
+*       [--export leituras.bin] [--list] [--full] segmento.col...
+*   (tempos em segundos Unix; os segmentos ficam em BROKER_ARCHIVE_DIR, 'archive' por padrão)
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sensor_archive.h"
+
+#define SENSOR_COLUMNS 4                // Temperatura, umidade, gás e luz, na ordem do modelo
+
+typedef struct {
+    double from_ms, to_ms;
+    double life_min, life_max;
+    const char *device;
+    int full_scan;
+} Query;
+
+typedef struct {
+    uint64_t rows, matched;
+    uint64_t blocks, blocks_read;
+    uint64_t stored_bytes, raw_bytes;
+    double sum[ARCHIVE_COLUMNS];
+    uint64_t count[ARCHIVE_COLUMNS];
+    int64_t first_ms, last_ms;
+} ScanTotals;
+
+static const char *const column_names[ARCHIVE_COLUMNS] = {
+    "tempo", "dispositivo", "temperatura", "umidade", "gás", "luz", "chance de vida"
+};
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void format_time(int64_t ms, char *out, size_t capacity) {
+    time_t seconds = (time_t)(ms / 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    strftime(out, capacity, "%Y-%m-%d %H:%M:%S", &utc);
+}
+
+static void count_block(const ArchiveBlock *block, ScanTotals *totals) {
+    totals->blocks++;
+    for (int c = 0; c < ARCHIVE_COLUMNS; ++c) {
+        totals->stored_bytes += block->chunks[c].size;
+        totals->raw_bytes += (uint64_t)block->rows * block->chunks[c].width;
+    }
+}
+
+/* Um bloco: zone maps, depois o filtro linha a linha só nas colunas do filtro */
+static int scan_block(const Archive *archive, uint32_t b, const Query *query, int device, ArchiveScratch *scratch,
+                      ScanTotals *totals, FILE *export_file) {
+    const ArchiveBlock *block = &archive->blocks[b];
+    count_block(block, totals);
+    int by_time = query->from_ms > -INFINITY || query->to_ms < INFINITY;
+    int by_life = query->life_min > -INFINITY || query->life_max < INFINITY;
+    if (!query->full_scan) {
+        if ((by_time && !archive_block_overlaps(archive, b, ARCHIVE_COL_TIME, query->from_ms, query->to_ms))
+            || (device >= 0 && !archive_block_overlaps(archive, b, ARCHIVE_COL_DEVICE, device, device))
+            || (by_life && !archive_block_overlaps(archive, b, ARCHIVE_COL_LIFE, query->life_min, query->life_max))) {
+            return 0;
+        }
+    }
+    totals->blocks_read++;
+
+    const int64_t *times = archive_column(archive, b, ARCHIVE_COL_TIME, scratch);
+    const uint16_t *devices = device >= 0 ? archive_column(archive, b, ARCHIVE_COL_DEVICE, scratch) : NULL;
+    const float *life = archive_column(archive, b, ARCHIVE_COL_LIFE, scratch);
+    if (!times || (device >= 0 && !devices) || !life) {
+        return -1;
+    }
+    const float *sensors[SENSOR_COLUMNS] = { NULL };
+    for (uint32_t r = 0; r < block->rows; ++r) {
+        double t = (double)times[r];
+        if (t < query->from_ms || t > query->to_ms || (devices && devices[r] != device)
+            || (by_life && !(life[r] >= query->life_min && life[r] <= query->life_max))) {
+            continue;
+        }
+        // Primeira linha aceita do bloco: só agora os canais são expandidos
+        if (!sensors[0]) {
+            for (int s = 0; s < SENSOR_COLUMNS; ++s) {
+                sensors[s] = archive_column(archive, b, ARCHIVE_COL_TEMPERATURE + s, scratch);
+                if (!sensors[s]) {
+                    return -1;
+                }
+            }
+        }
+        float reading[SENSOR_COLUMNS];
+        for (int s = 0; s < SENSOR_COLUMNS; ++s) {
+            reading[s] = sensors[s][r];
+            if (!isnan(reading[s])) {
+                totals->sum[ARCHIVE_COL_TEMPERATURE + s] += reading[s];
+                totals->count[ARCHIVE_COL_TEMPERATURE + s]++;
+            }
+        }
+        if (!isnan(life[r])) {
+            totals->sum[ARCHIVE_COL_LIFE] += life[r];
+            totals->count[ARCHIVE_COL_LIFE]++;
+        }
+        if (totals->matched == 0 || times[r] < totals->first_ms) totals->first_ms = times[r];
+        if (totals->matched == 0 || times[r] > totals->last_ms) totals->last_ms = times[r];
+        totals->matched++;
+        if (export_file && fwrite(reading, sizeof(reading), 1, export_file) != 1) {
+            perror("export");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int scan_segment(const char *path, const Query *query, int list, ScanTotals *totals, FILE *export_file) {
+    Archive archive;
+    ArchiveScratch scratch;
+    if (archive_open(&archive, path) != 0) {
+        return -1;
+    }
+    if (archive_scratch_init(&scratch, &archive) != 0) {
+        archive_close(&archive);
+        return -1;
+    }
+    const ArchiveHeader *header = archive.header;
+    totals->rows += header->rows;
+    if (list) {
+        char first[32], last[32];
+        format_time(header->min_time_ms, first, sizeof(first));
+        format_time(header->max_time_ms, last, sizeof(last));
+        printf("%s: ids %lld-%lld, %llu linhas em %u blocos, %u dispositivos, %s a %s\n", path,
+               (long long)header->first_id, (long long)header->last_id, (unsigned long long)header->rows,
+               header->blocks, header->names_count, first, last);
+    }
+
+    int result = 0;
+    // Segmento inteiro fora do intervalo: nenhum bloco é lido
+    int skip = !query->full_scan && ((double)header->max_time_ms < query->from_ms || (double)header->min_time_ms > query->to_ms);
+    int device = query->device ? archive_device_index(&archive, query->device) : -1;
+    if (query->device && device < 0) {
+        skip = 1;       // Dispositivo não aparece neste segmento
+    }
+    for (uint32_t b = 0; b < header->blocks; ++b) {
+        if (skip) {
+            count_block(&archive.blocks[b], totals);
+            continue;
+        }
+        if (scan_block(&archive, b, query, device, &scratch, totals, export_file) != 0) {
+            fprintf(stderr, "%s: bloco %u corrompido\n", path, b);
+            result = -1;
+            break;
+        }
+    }
+    archive_scratch_free(&scratch);
+    archive_close(&archive);
+    return result;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Uso: %s [--from s] [--to s] [--device nome] [--life-min p] [--life-max p] "
+                    "[--export leituras.bin] [--list] [--full] segmento.col...\n", program);
+}
+
+int main(int argc, char **argv) {
+    Query query = { -INFINITY, INFINITY, -INFINITY, INFINITY, NULL, 0 };
+    const char *export_path = NULL;
+    int list = 0, first_segment = argc;
+    for (int i = 1; i < argc; ++i) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--from") == 0 && has_value) {
+            query.from_ms = atof(argv[++i]) * 1000.0;
+        } else if (strcmp(argv[i], "--to") == 0 && has_value) {
+            query.to_ms = atof(argv[++i]) * 1000.0;
+        } else if (strcmp(argv[i], "--device") == 0 && has_value) {
+            query.device = argv[++i];
+        } else if (strcmp(argv[i], "--life-min") == 0 && has_value) {
+            query.life_min = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--life-max") == 0 && has_value) {
+            query.life_max = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--export") == 0 && has_value) {
+            export_path = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list = 1;
+        } else if (strcmp(argv[i], "--full") == 0) {
+            query.full_scan = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            first_segment = i;
+            break;
+        }
+    }
+    if (first_segment >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+    FILE *export_file = NULL;
+    if (export_path && !(export_file = fopen(export_path, "wb"))) {
+        perror(export_path);
+        return 2;
+    }
+
+    ScanTotals totals;
+    memset(&totals, 0, sizeof(totals));
+    int failed = 0;
+    double start = now_s();
+    for (int i = first_segment; i < argc; ++i) {
+        failed |= scan_segment(argv[i], &query, list, &totals, export_file) != 0;
+    }
+    double elapsed = now_s() - start;
+    if (export_file && fclose(export_file) != 0) {
+        perror(export_path);
+        failed = 1;
+    }
+
+    printf("Segmentos:  %d, %llu linhas, %.1f MB gravados (%.1fx menor que as colunas sem compressão)\n",
+           argc - first_segment, (unsigned long long)totals.rows, totals.stored_bytes / 1e6,
+           totals.stored_bytes ? (double)totals.raw_bytes / (double)totals.stored_bytes : 0.0);
+    printf("Blocos:     %llu de %llu lidos%s\n", (unsigned long long)totals.blocks_read,
+           (unsigned long long)totals.blocks, query.full_scan ? " (--full: sem zone maps)" : "");
+    printf("Linhas:     %llu encontradas em %.3f s (%.1f M linhas/s no arquivo)\n", (unsigned long long)totals.matched,
+           elapsed, elapsed > 0 ? totals.rows / elapsed / 1e6 : 0.0);
+    if (totals.matched) {
+        char first[32], last[32];
+        format_time(totals.first_ms, first, sizeof(first));
+        format_time(totals.last_ms, last, sizeof(last));
+        printf("Período:    %s a %s (UTC)\n", first, last);
+        for (int c = ARCHIVE_COL_TEMPERATURE; c < ARCHIVE_COLUMNS; ++c) {
+            printf("Média %-15s %.4f (%llu valores)\n", column_names[c],
+                   totals.count[c] ? totals.sum[c] / (double)totals.count[c] : NAN, (unsigned long long)totals.count[c]);
+        }
+    }
+    if (export_path) {
+        printf("Exportado:  %s (%llu linhas; ./score_history -f bin %s scores.bin)\n", export_path,
+               (unsigned long long)totals.matched, export_path);
+    }
+    return failed;
+}
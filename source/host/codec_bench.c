@@ -0,0 +1,177 @@
+/*
+* Benchmark do codec de telemetria (delta + varint) contra o JSON atual.
+*
+* Lê um trace gravado em CSV com as colunas temperature,humidity,gas,light,life_probability
+* (sem cabeçalho), por exemplo exportado do broker com:
+*   sqlite3 -csv planet_exploration.db "SELECT temperature, humidity, gas, light, life_probability FROM sensor_data" > trace.csv
+* Sem arquivo, usa um trace sintético (passeio aleatório com ruído de ADC).
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O2 -DIA_MODEL_NO_EXAMPLE -o codec_bench codec_bench.c ../esp32-firmware/telemetry_codec.c \
+*       ../ia_model/ia_model.c ../ia_model/ia_features.c -lm
+*   ./codec_bench trace.csv
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../esp32-firmware/telemetry_codec.h"
+#include "../ia_model/ia_model.h"
+
+#define DEVICE_NAME "RoboExplorador"
+#define SYNTHETIC_SAMPLES 100000
+#define BENCH_REPEAT 20
+
+typedef struct {
+    float temp, hum, gas, lux, life_chance;
+} TraceRow;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t load_trace(const char *path, TraceRow **rows) {
+    FILE *file = fopen(path, "r");
+    size_t count = 0, capacity = 1024;
+    char line[256];
+
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    *rows = malloc(capacity * sizeof(TraceRow));
+    while (fgets(line, sizeof(line), file)) {
+        TraceRow row;
+        if (sscanf(line, "%f,%f,%f,%f,%f", &row.temp, &row.hum, &row.gas, &row.lux, &row.life_chance) != 5) {
+            continue;   // Linhas com NULL (sistema desligado) ou cabeçalho
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            *rows = realloc(*rows, capacity * sizeof(TraceRow));
+        }
+        (*rows)[count++] = row;
+    }
+    fclose(file);
+    return count;
+}
+
+/* Passeio aleatório lento em cada canal, no passo do ADC, com ruído de ±2 códigos */
+static size_t synthetic_trace(TraceRow **rows) {
+    int32_t code[4] = { 1600, 2600, 900, 2200 };
+    const float max[4] = { MAX_TEMPERATURE_READING, 100.0f, MAX_GAS_READING, MAX_LIGHT_READING };
+
+    *rows = malloc(SYNTHETIC_SAMPLES * sizeof(TraceRow));
+    srand(42);
+    for (size_t i = 0; i < SYNTHETIC_SAMPLES; ++i) {
+        float value[4];
+        for (int c = 0; c < 4; ++c) {
+            if (rand() % 8 == 0) code[c] += rand() % 3 - 1;
+            int32_t noisy = code[c] + rand() % 5 - 2;
+            if (noisy < 0) noisy = 0;
+            if (noisy > CODEC_ADC_FULL_SCALE) noisy = CODEC_ADC_FULL_SCALE;
+            value[c] = (float)noisy / CODEC_ADC_FULL_SCALE * max[c];
+        }
+        float input[INPUT_SIZE] = { value[0], value[1], value[2], value[3] };
+        normalize_readings(input);
+        (*rows)[i] = (TraceRow){ value[0], value[1], value[2], value[3], model_predict(input) };
+    }
+    return SYNTHETIC_SAMPLES;
+}
+
+static void quantize_row(const TraceRow *row, CodecSample *sample) {
+    sample->values[0] = codec_quantize(row->temp, MAX_TEMPERATURE_READING, CODEC_ADC_FULL_SCALE);
+    sample->values[1] = codec_quantize(row->hum, 100.0f, CODEC_ADC_FULL_SCALE);
+    sample->values[2] = codec_quantize(row->gas, MAX_GAS_READING, CODEC_ADC_FULL_SCALE);
+    sample->values[3] = codec_quantize(row->lux, MAX_LIGHT_READING, CODEC_ADC_FULL_SCALE);
+    sample->values[CODEC_CHANNEL_LIFE] = codec_quantize(row->life_chance, 1.0f, CODEC_LIFE_SCALE);
+    sample->flags = CODEC_FLAG_SYSTEM_ON | CODEC_FLAG_PREDICTED
+        | (codec_terrain_class(1, row->life_chance) << CODEC_TERRAIN_SHIFT);
+}
+
+/* Mesmo documento que sendDataToBrokerUDP monta com ArduinoJson */
+static int json_size(const TraceRow *row) {
+    char buffer[512];
+    const char *status = row->life_chance >= 0.70f ? "Propício à vida ✅"
+        : row->life_chance >= 0.5f ? "Condição Moderada 🟨" : "Ambiente Hostil ❌";
+    return snprintf(buffer, sizeof(buffer),
+        "{\"source\":\"%s\",\"type\":\"sensor_data\",\"data\":{\"temp\":%.6g,\"hum\":%.6g,\"gas\":%.6g,"
+        "\"lux\":%.6g,\"life_chance\":%.6g,\"terrain_status\":\"%s\",\"system_on\":true}}",
+        DEVICE_NAME, row->temp, row->hum, row->gas, row->lux, row->life_chance, status);
+}
+
+int main(int argc, char **argv) {
+    TraceRow *rows;
+    size_t count = argc > 1 ? load_trace(argv[1], &rows) : synthetic_trace(&rows);
+    CodecSample *samples;
+    CodecEncoder encoder;
+    CodecDecoder decoder;
+    uint8_t frame[CODEC_MAX_FRAME];
+    size_t codec_bytes = 0, traced_bytes = 0, json_bytes = 0, mismatches = 0;
+
+    if (count == 0) {
+        fprintf(stderr, "Trace vazio.\n");
+        return 1;
+    }
+    samples = malloc(count * sizeof(CodecSample));
+    for (size_t i = 0; i < count; ++i) {
+        quantize_row(&rows[i], &samples[i]);
+        json_bytes += (size_t)json_size(&rows[i]);
+    }
+
+    // Tamanho e ida e volta pelo decodificador
+    codec_encoder_init(&encoder);
+    codec_decoder_init(&decoder);
+    for (size_t i = 0; i < count; ++i) {
+        CodecSample decoded;
+        size_t n = codec_encode(&encoder, DEVICE_NAME, &samples[i], frame, sizeof(frame));
+        codec_bytes += n;
+        if (codec_decode(&decoder, frame, n, &decoded) != 1
+            || memcmp(decoded.values, samples[i].values, sizeof(decoded.values)) != 0
+            || decoded.flags != samples[i].flags) {
+            mismatches++;
+        }
+    }
+
+    // Com rastro (CODEC_FLAG_TRACE): captura e envio a cada 500 ms, com atraso variável até o envio
+    codec_encoder_init(&encoder);
+    codec_decoder_init(&decoder);
+    for (size_t i = 0; i < count; ++i) {
+        CodecSample traced = samples[i], decoded;
+        traced.flags |= CODEC_FLAG_TRACE;
+        traced.capture_ms = 4000000000u + (uint32_t)i * 500u;   // Passa pela volta do millis()
+        traced.send_ms = traced.capture_ms + 3 + (uint32_t)(i % 40);
+        size_t n = codec_encode(&encoder, DEVICE_NAME, &traced, frame, sizeof(frame));
+        traced_bytes += n;
+        if (codec_decode(&decoder, frame, n, &decoded) != 1 || decoded.flags != traced.flags
+            || decoded.send_ms != traced.send_ms || decoded.capture_ms != traced.capture_ms) {
+            mismatches++;
+        }
+    }
+
+    // Tempo de codificação
+    volatile size_t sink = 0;
+    double start = now_ns();
+    for (int r = 0; r < BENCH_REPEAT; ++r) {
+        codec_encoder_init(&encoder);
+        for (size_t i = 0; i < count; ++i) {
+            sink += codec_encode(&encoder, DEVICE_NAME, &samples[i], frame, sizeof(frame));
+        }
+    }
+    double encode_ns = (now_ns() - start) / ((double)count * BENCH_REPEAT);
+
+    printf("Amostras:            %zu\n", count);
+    printf("JSON:                %.2f bytes/amostra\n", (double)json_bytes / count);
+    printf("Delta + varint:      %.2f bytes/amostra\n", (double)codec_bytes / count);
+    printf("Taxa de compressão:  %.1fx\n", (double)json_bytes / codec_bytes);
+    printf("Com rastro:          %.2f bytes/amostra\n", (double)traced_bytes / count);
+    printf("Codificação:         %.1f ns/amostra\n", encode_ns);
+    printf("Divergências:        %zu\n", mismatches);
+
+    free(samples);
+    free(rows);
+    return mismatches ? 1 : 0;
+}
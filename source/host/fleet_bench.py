@@ -0,0 +1,213 @@
+"""
+Benchmark do lado dos dispositivos do broker contra uma frota simulada local.
+
+Sobe o broker no próprio processo (portas livres, banco e fotos num diretório temporário) e, num
+processo separado, uma frota de N robôs simulados num laço asyncio: cada robô abre a conexão TCP de
+comandos, se registra, confirma (ack) os comandos recebidos e manda leituras JSON por UDP na taxa
+pedida. Mede:
+- registro: tempo até o broker ver os N dispositivos online;
+- ingestão UDP: datagramas processados por segundo, perdas e atraso do laço;
+- comandos: ida e volta (envio até ack) com a frota inteira transmitindo;
+- rastro: latência por etapa (fila no robô, rede, ingestão, gravação). Cada robô simulado tem o
+  próprio millis(), deslocado do relógio do broker, e responde ao time_sync como o firmware.
+
+Executar (a partir de source/host, com as dependências do broker instaladas):
+    python3 fleet_bench.py [--devices 1000] [--rate 2] [--seconds 10] [--commands 500]
+"""
+
+import argparse
+import asyncio
+import json
+import multiprocessing
+import os
+import random
+import resource
+import socket
+import sys
+import tempfile
+import time
+
+FIRMWARE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'esp32-firmware')
+
+
+def free_port(kind):
+    with socket.socket(socket.AF_INET, kind) as sock:
+        sock.bind(('127.0.0.1', 0))
+        return sock.getsockname()[1]
+
+
+def raise_file_limit():
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    if soft < hard:
+        resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+    return resource.getrlimit(resource.RLIMIT_NOFILE)[0]
+
+
+# ---------------- Frota simulada (processo filho) ----------------
+
+DEVICE_QUEUE_MS = 5    # Atraso simulado entre a captura no ADC e o envio
+
+
+def device_millis(offset):
+    return (int(time.monotonic() * 1000) + offset) & 0xFFFFFFFF
+
+
+async def simulated_device(name, offset, command_port, registered, acks):
+    reader, writer = await asyncio.open_connection('127.0.0.1', command_port)
+    writer.write(json.dumps({"type": "register", "name": name}).encode() + b'\n')
+    await writer.drain()
+    registered.append(name)
+    buffer = b""
+    system_on = True
+    while True:
+        data = await reader.read(1024)
+        if not data:
+            return
+        buffer += data
+        while b'\n' in buffer:
+            line, buffer = buffer.split(b'\n', 1)
+            command = json.loads(line)
+            if command.get("command") == "time_sync":
+                writer.write(json.dumps({"type": "time_sync", "id": command["id"],
+                                         "device_ms": device_millis(offset)}).encode() + b'\n')
+                continue
+            received_ms = int(time.monotonic() * 1000)
+            system_on = not system_on
+            writer.write(json.dumps({"type": "ack", "id": command["id"], "received_ms": received_ms,
+                                     "applied_ms": received_ms, "system_on": system_on}).encode() + b'\n')
+            acks[0] += 1
+
+
+async def run_fleet(devices, rate, seconds, command_port, data_port, control):
+    registered, acks = [], [0]
+    tasks = []
+    offsets = [random.randrange(1 << 32) for _ in range(devices)]
+    for i in range(devices):
+        tasks.append(asyncio.ensure_future(simulated_device(f"robo{i:05d}", offsets[i], command_port, registered, acks)))
+        if i % 100 == 99:
+            await asyncio.sleep(0)   # Não estoura o backlog do accept
+    while len(registered) < devices:
+        await asyncio.sleep(0.01)
+    control.send(("registered", devices))
+    control.recv()                   # Espera o broker confirmar os registros
+
+    # Leituras: cada robô manda 'rate' por segundo, espalhadas no segundo
+    udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    # Corpo fixo por robô; o rastro (seq, captura, envio) muda a cada leitura
+    bodies = [json.dumps({"source": f"robo{i:05d}", "type": "sensor_data", "data": {
+        "temp": 20.0 + i % 10, "hum": 55.0, "gas": 80.0, "lux": 400.0, "life_chance": 0.42,
+        "terrain_status": "Condição Moderada 🟨", "system_on": True}})[:-1] for i in range(devices)]
+    sent = 0
+    start = time.monotonic()
+    period = 1.0 / (devices * rate)
+    while time.monotonic() - start < seconds:
+        due = int((time.monotonic() - start) / period)
+        while sent < due:
+            i = sent % devices
+            send_ms = device_millis(offsets[i])
+            trace = f', "trace": {{"seq": {sent // devices}, "capture_ms": {(send_ms - DEVICE_QUEUE_MS) & 0xFFFFFFFF}, "send_ms": {send_ms}}}}}'
+            udp.sendto((bodies[i] + trace).encode(), ('127.0.0.1', data_port))
+            sent += 1
+        await asyncio.sleep(0.001)
+    control.send(("sent", sent, time.monotonic() - start))
+    control.recv()                   # Fim: o broker já mediu os comandos
+    control.send(("acks", acks[0]))
+    for task in tasks:
+        task.cancel()
+
+
+def fleet_process(devices, rate, seconds, command_port, data_port, control):
+    raise_file_limit()
+    asyncio.run(run_fleet(devices, rate, seconds, command_port, data_port, control))
+
+
+# ---------------- Broker (processo principal) ----------------
+
+def percentile(values, p):
+    if not values:
+        return None
+    ordered = sorted(values)
+    return round(ordered[min(len(ordered) - 1, int(p / 100.0 * len(ordered)))], 2)
+
+
+def wait_until(condition, timeout):
+    deadline = time.monotonic() + timeout
+    while not condition() and time.monotonic() < deadline:
+        time.sleep(0.01)
+    return condition()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark do broker contra uma frota simulada")
+    parser.add_argument('--devices', type=int, default=1000)
+    parser.add_argument('--rate', type=float, default=2.0, help="leituras por segundo por robô")
+    parser.add_argument('--seconds', type=float, default=10.0)
+    parser.add_argument('--commands', type=int, default=500, help="comandos enviados durante a ingestão")
+    args = parser.parse_args()
+
+    limit = raise_file_limit()
+    if 2 * args.devices + 64 > limit:
+        sys.exit(f"Limite de arquivos abertos ({limit}) baixo para {args.devices} robôs (precisa de ~{2 * args.devices + 64}).")
+
+    workdir = tempfile.mkdtemp(prefix='fleet_bench_')
+    command_port, data_port = free_port(socket.SOCK_STREAM), free_port(socket.SOCK_DGRAM)
+    os.environ.update(BROKER_DB=os.path.join(workdir, 'bench.db'), BROKER_PHOTOS_DIR=os.path.join(workdir, 'photos'),
+                      BROKER_COMMAND_PORT=str(command_port), BROKER_DATA_PORT=str(data_port))
+    sys.path.insert(0, FIRMWARE_DIR)
+    import logging
+    import broker as broker_module
+    logging.getLogger().setLevel(logging.WARNING)
+    broker = broker_module.broker
+
+    control, child_control = multiprocessing.Pipe()
+    start = time.monotonic()
+    fleet = multiprocessing.Process(target=fleet_process, args=(args.devices, args.rate, args.seconds,
+                                                                command_port, data_port, child_control))
+    fleet.start()
+    control.recv()
+    wait_until(lambda: broker.stats()['devices_online'] >= args.devices, 30)
+    register_s = time.monotonic() - start
+    online = broker.stats()['devices_online']
+    control.send("go")
+
+    # Comandos espalhados ao longo da ingestão, para robôs sorteados
+    base = broker.stats()
+    ingest_start = time.monotonic()
+    pending, lag = [], []
+    names = [f"robo{i:05d}" for i in range(args.devices)]
+    for n in range(args.commands):
+        target = ingest_start + (n + 0.5) * args.seconds / max(1, args.commands)
+        time.sleep(max(0.0, target - time.monotonic()))
+        pending.append(broker.send_command(random.choice(names), "toggle_system_state"))
+        lag.append(broker.loop_lag_ms)
+    _, sent, send_s = control.recv()
+    wait_until(lambda: broker.stats()['udp_datagrams'] - base['udp_datagrams'] >= sent, 10)
+    ingest_s = time.monotonic() - ingest_start
+    for command in pending:
+        command.done.wait(broker_module.COMMAND_WAIT_TIMEOUT)
+    wait_until(lambda: broker.stats()['store_queue'] == 0, 30)
+    control.send("done")
+    _, acks = control.recv()
+    fleet.join(5)
+
+    stats = broker.stats()
+    received = stats['udp_datagrams'] - base['udp_datagrams']
+    round_trip = [c.result["latency_ms"] for c in pending if c.status == "acked"]
+    print(f"Robôs:               {args.devices} ({online} online no broker), registro em {register_s:.2f} s")
+    print(f"Leituras UDP:        {sent} enviadas em {send_s:.1f} s, {received} processadas "
+          f"({received / ingest_s:.0f}/s, perda {100.0 * (sent - received) / max(1, sent):.2f}%)")
+    print(f"SQLite:              {stats['stored']} linhas gravadas, {stats['store_dropped']} descartadas")
+    print(f"Comandos:            {len(round_trip)}/{len(pending)} confirmados ({acks} acks na frota), ida e volta "
+          f"p50 {percentile(round_trip, 50)} ms, p99 {percentile(round_trip, 99)} ms, máx {percentile(round_trip, 100)} ms")
+    print(f"Laço de eventos:     atraso p50 {percentile(lag, 50)} ms, máx {percentile(lag, 100)} ms, "
+          f"{stats['writes_rejected']} envios recusados")
+    hops = broker.trace_stats.to_dict()
+    synced = sum(1 for shard in broker.shards for state in shard.devices.values() if state.clock.offset_ms is not None)
+    print(f"Rastro por etapa:    relógio sincronizado em {synced}/{args.devices} robôs")
+    for hop in ('device_queue', 'network', 'ingest', 'store'):
+        h = hops[hop]
+        print(f"  {hop:<17} {h['count']:>8} amostras, p50 {h['p50_ms']} ms, p99 {h['p99_ms']} ms, máx {h['max_ms']} ms")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,237 @@
+/*
+* Decodificador do log binário do firmware (async_log.h, LOG_OUTPUT_BINARY) e benchmark do log.
+*
+* Modo padrão: lê a captura da serial (arquivo ou stdin) e imprime cada quadro como a linha de texto
+* que o firmware imprimiria no modo texto; bytes fora de quadros (mensagens de setup escritas direto
+* na Serial) passam como estão. A tabela de mensagens (log_messages.h) deve ser a do firmware gravado.
+* Modo --bench: mede o custo de uma chamada de log no anel contra a formatação completa, confere a
+* ida e volta texto/binário de um ciclo de leitura e martela o anel com dois produtores e um consumidor.
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O2 -pthread -I../esp32-firmware -o log_decode log_decode.c ../esp32-firmware/async_log.c
+*   ./log_decode captura.bin          (ex.: captura com 'cat /dev/ttyUSB0 > captura.bin' a 9600 baud)
+*   ./log_decode --bench [registros]
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "async_log.h"
+
+#define DEFAULT_BENCH_RECORDS 2000000UL
+#define SERIAL_MS_PER_BYTE (10.0 / 9.6)    // 9600 baud, 8N1: 10 bits por byte
+#define READ_CHUNK 4096
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint32_t bench_clock(void) {
+    return (uint32_t)(now_ns() / 1e6);
+}
+
+/* ---------------- Decodificação ---------------- */
+
+static int decode_stream(FILE *input) {
+    static uint8_t buffer[2 * READ_CHUNK];
+    size_t length = 0, frames = 0, invalid = 0;
+    size_t got;
+
+    while ((got = fread(buffer + length, 1, sizeof(buffer) - length, input)) > 0 || length > 0) {
+        int at_end = got == 0;
+        length += got;
+        size_t pos = 0;
+        while (pos < length) {
+            if (buffer[pos] != LOG_SYNC_0) {
+                putchar(buffer[pos++]);
+                continue;
+            }
+            LogRecord record;
+            char strings[LOG_MAX_ARGS * (LOG_MAX_STRING + 1)];
+            int consumed = log_decode_frame(buffer + pos, length - pos, &record, strings, sizeof(strings));
+            if (consumed == 0 && !at_end) {
+                break;  // Quadro incompleto: espera o próximo bloco
+            }
+            if (consumed <= 0) {
+                if (consumed < 0 && pos + 1 < length && buffer[pos + 1] == LOG_SYNC_1) {
+                    invalid++;
+                }
+                putchar(buffer[pos++]);
+                continue;
+            }
+            char line[LOG_MAX_LINE];
+            fwrite(line, 1, log_format_record(&record, line, sizeof(line)), stdout);
+            frames++;
+            pos += (size_t)consumed;
+        }
+        memmove(buffer, buffer + pos, length - pos);
+        length -= pos;
+        if (at_end) {
+            break;
+        }
+    }
+    fprintf(stderr, "%zu registros decodificados, %zu quadros inválidos\n", frames, invalid);
+    return 0;
+}
+
+/* ---------------- Benchmark ---------------- */
+
+/* Um ciclo de leitura típico do handlePipelineSample */
+static size_t tick_records(LogRecord *records) {
+    static const struct { uint16_t id; int nargs; char type[LOG_MAX_ARGS]; } tick[] = {
+        { LOG_MSG_SEPARATOR, 0, "" },
+        { LOG_MSG_TEMPERATURE, 1, "f" },
+        { LOG_MSG_HUMIDITY, 1, "f" },
+        { LOG_MSG_GAS, 1, "f" },
+        { LOG_MSG_LIGHT, 1, "f" },
+        { LOG_MSG_INTERVAL, 2, "us" },
+        { LOG_MSG_LIFE_CHANCE, 1, "f" },
+        { LOG_MSG_PLANET_STATUS, 1, "s" },
+        { LOG_MSG_WIFI_STATUS, 1, "s" },
+        { LOG_MSG_SYSTEM_STATUS, 1, "s" },
+    };
+    size_t count = sizeof(tick) / sizeof(tick[0]);
+    for (size_t r = 0; r < count; ++r) {
+        LogRecord *record = &records[r];
+        record->timestamp_ms = 123456 + (uint32_t)r;
+        record->id = tick[r].id;
+        record->level = LOG_LEVEL_INFO;
+        record->nargs = (uint8_t)tick[r].nargs;
+        for (int a = 0; a < tick[r].nargs; ++a) {
+            if (tick[r].type[a] == 'f') record->args[a].f = 12.3456f * (float)(r + 1);
+            else if (tick[r].type[a] == 'u') record->args[a].u = 500;
+            else record->args[a].s = r == 7 ? "Condição Moderada 🟨" : r == 5 ? "" : "Ligado";
+        }
+    }
+    return count;
+}
+
+static unsigned long producer_records;
+static unsigned long producer_rejected[2];
+static int producers_done;
+
+static void *producer_thread(void *arg) {
+    long producer = (long)arg;
+    static const char *names[2] = { "A", "B" };
+    for (unsigned long seq = 0; seq < producer_records; ++seq) {
+        LogArg args[2];
+        args[0].s = names[producer];
+        args[1].i = (int32_t)seq;
+        // No firmware o registro recusado fica só na contagem; aqui tenta de novo para cobrir todos
+        while (!log_write(LOG_LEVEL_INFO, LOG_MSG_BROKER_CONNECTING, 2, args)) {
+            producer_rejected[producer]++;
+            sched_yield();
+        }
+    }
+    __atomic_fetch_add(&producers_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static int run_bench(unsigned long records) {
+    LogRecord record, tick[16];
+    char line[LOG_MAX_LINE];
+    uint8_t frame[LOG_MAX_FRAME];
+    volatile size_t sink = 0;
+    int failed = 0;
+
+    // Custo no caminho quente: gravar no anel (e drenar, para o anel não encher)
+    log_init(bench_clock);
+    LogArg value;
+    value.f = 23.45f;
+    double start = now_ns();
+    for (unsigned long i = 0; i < records; ++i) {
+        log_write(LOG_LEVEL_INFO, LOG_MSG_TEMPERATURE, 1, &value);
+        log_pop(&record);
+    }
+    double write_ns = (now_ns() - start) / records;
+
+    // Custo da formatação completa, que o Serial.printf fazia no caminho quente
+    start = now_ns();
+    for (unsigned long i = 0; i < records; ++i) {
+        sink += log_format_record(&record, line, sizeof(line));
+    }
+    double format_ns = (now_ns() - start) / records;
+
+    // Ida e volta de um ciclo de leitura: texto direto == texto do quadro binário decodificado
+    size_t count = tick_records(tick), text_bytes = 0, binary_bytes = 0, mismatches = 0;
+    for (size_t r = 0; r < count; ++r) {
+        char direct[LOG_MAX_LINE], decoded[LOG_MAX_LINE], strings[LOG_MAX_ARGS * (LOG_MAX_STRING + 1)];
+        LogRecord back;
+        size_t text = log_format_record(&tick[r], direct, sizeof(direct));
+        size_t size = log_encode_record(&tick[r], frame, sizeof(frame));
+        int consumed = log_decode_frame(frame, size, &back, strings, sizeof(strings));
+        if (consumed != (int)size || log_format_record(&back, decoded, sizeof(decoded)) != text
+            || memcmp(direct, decoded, text) != 0) {
+            mismatches++;
+        }
+        text_bytes += text;
+        binary_bytes += size;
+    }
+
+    printf("Chamada de log (anel):   %.0f ns\n", write_ns);
+    printf("Formatação da linha:     %.0f ns\n", format_ns);
+    printf("Ciclo de leitura:        %zu registros, texto %zu bytes (%.0f ms na serial), binário %zu bytes (%.0f ms)\n",
+           count, text_bytes, text_bytes * SERIAL_MS_PER_BYTE, binary_bytes, binary_bytes * SERIAL_MS_PER_BYTE);
+    printf("Ida e volta binária:     %s\n", mismatches ? "FALHA" : "OK");
+    failed |= mismatches != 0;
+
+    // Dois produtores e um consumidor: ordem por produtor e nada perdido sem ser contado
+    log_init(bench_clock);
+    producer_records = records / 4;
+    pthread_t producers[2];
+    unsigned long received[2] = { 0, 0 }, out_of_order = 0;
+    int32_t last[2] = { -1, -1 };
+    for (long p = 0; p < 2; ++p) {
+        pthread_create(&producers[p], NULL, producer_thread, (void *)p);
+    }
+    for (;;) {
+        // 'done' lido antes do pop: se o anel estiver vazio depois disso, tudo já foi consumido
+        int done = __atomic_load_n(&producers_done, __ATOMIC_ACQUIRE) == 2;
+        if (!log_pop(&record)) {
+            if (done) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        int p = record.args[0].s[0] - 'A';
+        if (record.args[1].i <= last[p]) {
+            out_of_order++;
+        }
+        last[p] = record.args[1].i;
+        received[p]++;
+    }
+    for (int p = 0; p < 2; ++p) {
+        pthread_join(producers[p], NULL);
+    }
+    unsigned long lost = 2 * producer_records - (received[0] + received[1]);
+    unsigned long rejected = producer_rejected[0] + producer_rejected[1];
+    printf("Produtores concorrentes: %lu registros, %lu recusados com o anel cheio (contados: %u), %lu perdidos, %lu fora de ordem\n",
+           2 * producer_records, rejected, log_dropped(), lost, out_of_order);
+    failed |= lost != 0 || out_of_order != 0 || rejected != log_dropped();
+    printf("Resultado:               %s\n", failed ? "FALHA" : "OK");
+    (void)sink;
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return run_bench(argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_BENCH_RECORDS);
+    }
+    FILE *input = argc > 1 ? fopen(argv[1], "rb") : stdin;
+    if (!input) {
+        perror(argv[1]);
+        return 1;
+    }
+    int result = decode_stream(input);
+    if (input != stdin) {
+        fclose(input);
+    }
+    return result;
+}
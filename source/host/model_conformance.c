@@ -0,0 +1,476 @@
+/*
+* Conformidade numérica das implementações do modelo (ia_model.h) contra o caminho de referência.
+*
+* Vetores de referência (entrada física + saída de normalize_readings + model_predict em float):
+*   - grade: steps^4 pontos igualmente espaçados em [0, MAX_*] (temperatura, umidade, gás, luz);
+*   - ADC: códigos 0, 1, 2047, 4094 e 4095 em cada canal, convertidos como em pipeline.c;
+*   - limiar: pares de entradas vizinhas, achados por bisseção em segmentos sorteados, em que a
+*     referência fica logo abaixo e logo acima de LIFE_THRESHOLD_MODERATE e LIFE_THRESHOLD_FAVORABLE.
+* Cada implementação é conferida contra eles: erro absoluto máximo e médio, concordância de classe
+* (hostil / moderado / propício) e vazão. Uma divergência de classe só é aceita quando a referência
+* está a menos da tolerância da implementação de um dos limiares; acima da tolerância ou com outra
+* divergência a implementação falha e o programa sai com código 1.
+*
+* As candidatas (sigmoid aproximada, ponto fixo Q12) não estão no firmware: ficam aqui para mostrar a
+* troca entre velocidade e precisão. Uma nova variante entra como mais uma linha em 'backends'.
+*
+* Os vetores podem ser gravados (-w) e relidos (-r): relidos depois de um retreino, de uma troca de
+* compilador ou de flags, a linha da própria referência mostra se o caminho de referência mudou.
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O2 -DIA_MODEL_NO_EXAMPLE -I../ia_model -o model_conformance model_conformance.c \
+*       ../ia_model/ia_model.c ../ia_model/ia_features.c -lm
+*   ./model_conformance [-g passos] [-w vetores.csv] [-r vetores.csv]
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ia_model.h"
+#include "ia_model_gen.h"
+
+#define DEFAULT_GRID_STEPS 11
+#define ADC_FULL_SCALE 4095
+#define THRESHOLD_SEGMENTS 256          // Segmentos por limiar
+#define THRESHOLD_ATTEMPTS 100000       // Sorteios para achar pontos dos dois lados de um limiar
+#define BISECTION_STEPS 48
+#define BENCH_MIN_SAMPLES 2000000UL
+#define FIXED_SHIFT 12                  // Ponto fixo Q12
+
+enum { CASE_GRID, CASE_ADC, CASE_THRESHOLD, CASE_COUNT };
+static const char *const case_names[CASE_COUNT] = { "grade", "adc", "limiar" };
+
+typedef struct {
+    float reading[INPUT_SIZE];          // Valores físicos, sem normalizar
+    float expected;
+    int category;
+} GoldenVector;
+
+typedef struct {
+    GoldenVector *items;
+    size_t count;
+    size_t capacity;
+} GoldenSet;
+
+/* Uma implementação: 'count' linhas de INPUT_SIZE leituras físicas -> chances de vida */
+typedef void (*BackendRun)(const float *readings, float *out, size_t count);
+
+typedef struct {
+    const char *name;
+    BackendRun run;
+    float tolerance;                    // Erro absoluto aceito
+} Backend;
+
+static const float maxima[INPUT_SIZE] = { MAX_TEMPERATURE_READING, 100.0f, MAX_GAS_READING, (float)MAX_LIGHT_READING };
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int classify(float chance) {
+    return (chance >= LIFE_THRESHOLD_MODERATE) + (chance >= LIFE_THRESHOLD_FAVORABLE);
+}
+
+/* Caminho de referência: o mesmo do loop() antigo e da documentação do modelo */
+static float reference_predict(const float reading[INPUT_SIZE]) {
+    float input[INPUT_SIZE];
+    memcpy(input, reading, sizeof(input));
+    normalize_readings(input);
+    return model_predict(input);
+}
+
+/* ---------------- Implementações ---------------- */
+
+static void run_reference(const float *readings, float *out, size_t count) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = reference_predict(readings + r * INPUT_SIZE);
+    }
+}
+
+static void run_extended(const float *readings, float *out, size_t count) {
+    static const float features[FEATURE_SIZE] = { 0 };
+    for (size_t r = 0; r < count; ++r) {
+        float input[INPUT_SIZE];
+        memcpy(input, readings + r * INPUT_SIZE, sizeof(input));
+        normalize_readings(input);
+        out[r] = model_predict_ext(input, features);
+    }
+}
+
+static void run_batch(const float *readings, float *out, size_t count) {
+    model_predict_batch(readings, out, count);
+}
+
+static void run_generated(const float *readings, float *out, size_t count) {
+    static const float features[FEATURE_SIZE] = { 0 };
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = model_predict_generated(readings + r * INPUT_SIZE, features);
+    }
+}
+
+/* Candidata: exp por 2^x com a parte fracionária num polinômio de grau 3 (erro relativo ~1e-4) */
+static float fast_expf(float x) {
+    if (x < -87.0f) x = -87.0f;
+    if (x > 87.0f) x = 87.0f;
+    float t = x * 1.44269504f;
+    float whole = floorf(t);
+    float f = t - whole;
+    float p = 1.0f + f * (0.695556856f + f * (0.226173572f + f * 0.0781455737f));
+    union { float f; int32_t i; } bits = { p };
+    bits.i += (int32_t)whole << 23;
+    return bits.f;
+}
+
+static void run_fast_sigmoid(const float *readings, float *out, size_t count) {
+    for (size_t r = 0; r < count; ++r) {
+        float input[INPUT_SIZE];
+        memcpy(input, readings + r * INPUT_SIZE, sizeof(input));
+        normalize_readings(input);
+        float output = b2;
+        for (int i = 0; i < HIDDEN_SIZE; ++i) {
+            float hidden = b1[i];
+            for (int j = 0; j < INPUT_SIZE; ++j) {
+                hidden += input[j] * W1[j][i];
+            }
+            output += relu(hidden) * W2[i];
+        }
+        out[r] = 1.0f / (1.0f + fast_expf(-output));
+    }
+}
+
+/* Candidata: entradas normalizadas e pesos em Q12, acumulação inteira, sigmoid em float */
+static int32_t fixed_w1[INPUT_SIZE][HIDDEN_SIZE], fixed_b1[HIDDEN_SIZE], fixed_w2[HIDDEN_SIZE];
+static int64_t fixed_b2;
+
+static int32_t to_fixed(float value) {
+    return (int32_t)lroundf(value * (float)(1 << FIXED_SHIFT));
+}
+
+static void fixed_init(void) {
+    for (int i = 0; i < HIDDEN_SIZE; ++i) {
+        for (int j = 0; j < INPUT_SIZE; ++j) {
+            fixed_w1[j][i] = to_fixed(W1[j][i]);
+        }
+        fixed_b1[i] = to_fixed(b1[i]) << FIXED_SHIFT;      // Q24, a escala do produto
+        fixed_w2[i] = to_fixed(W2[i]);
+    }
+    fixed_b2 = (int64_t)to_fixed(b2) << FIXED_SHIFT;
+}
+
+static void run_fixed_q12(const float *readings, float *out, size_t count) {
+    for (size_t r = 0; r < count; ++r) {
+        float input[INPUT_SIZE];
+        int32_t x[INPUT_SIZE];
+        memcpy(input, readings + r * INPUT_SIZE, sizeof(input));
+        normalize_readings(input);
+        for (int j = 0; j < INPUT_SIZE; ++j) {
+            x[j] = to_fixed(input[j]);
+        }
+        int64_t output = fixed_b2;
+        for (int i = 0; i < HIDDEN_SIZE; ++i) {
+            int32_t hidden = fixed_b1[i];
+            for (int j = 0; j < INPUT_SIZE; ++j) {
+                hidden += x[j] * fixed_w1[j][i];
+            }
+            if (hidden > 0) {
+                output += (int64_t)(hidden >> FIXED_SHIFT) * fixed_w2[i];
+            }
+        }
+        out[r] = sigmoid((float)output / (float)(1 << (2 * FIXED_SHIFT)));
+    }
+}
+
+static const Backend backends[] = {
+    { "referência (model_predict)", run_reference, 0.0f },
+    { "estendida (model_predict_ext)", run_extended, 0.0f },
+    { "lote (model_predict_batch)", run_batch, 1e-6f },
+    { "gerada (ia_model_gen.h)", run_generated, 1e-5f },
+    { "candidata: sigmoid aproximada", run_fast_sigmoid, 1e-4f },
+    { "candidata: ponto fixo Q12", run_fixed_q12, 1e-3f },
+};
+#define BACKEND_COUNT (sizeof(backends) / sizeof(backends[0]))
+
+/* ---------------- Vetores de referência ---------------- */
+
+static void golden_add(GoldenSet *set, const float reading[INPUT_SIZE], float expected, int category) {
+    if (set->count == set->capacity) {
+        set->capacity = set->capacity ? 2 * set->capacity : 4096;
+        set->items = realloc(set->items, set->capacity * sizeof(GoldenVector));
+        if (!set->items) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+    GoldenVector *vector = &set->items[set->count++];
+    memcpy(vector->reading, reading, sizeof(vector->reading));
+    vector->expected = expected;
+    vector->category = category;
+}
+
+static void golden_add_reference(GoldenSet *set, const float reading[INPUT_SIZE], int category) {
+    golden_add(set, reading, reference_predict(reading), category);
+}
+
+static uint32_t rng_state = 0x2545F491u;
+
+static float random_unit(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (float)(rng_state >> 8) / (float)(1u << 24);
+}
+
+static void random_reading(float reading[INPUT_SIZE]) {
+    for (int j = 0; j < INPUT_SIZE; ++j) {
+        reading[j] = maxima[j] * random_unit();
+    }
+}
+
+/* Bisseção no segmento below -> above até as duas pontas ficarem vizinhas; adiciona as duas */
+static void add_threshold_pair(GoldenSet *set, const float below[INPUT_SIZE], const float above[INPUT_SIZE], float threshold) {
+    float lo[INPUT_SIZE], hi[INPUT_SIZE];
+    memcpy(lo, below, sizeof(lo));
+    memcpy(hi, above, sizeof(hi));
+    for (int step = 0; step < BISECTION_STEPS; ++step) {
+        float mid[INPUT_SIZE];
+        int moved = 0;
+        for (int j = 0; j < INPUT_SIZE; ++j) {
+            mid[j] = lo[j] + 0.5f * (hi[j] - lo[j]);
+            moved |= mid[j] != lo[j] && mid[j] != hi[j];
+        }
+        if (!moved) {
+            break;      // Sem float entre as pontas
+        }
+        if (reference_predict(mid) < threshold) {
+            memcpy(lo, mid, sizeof(lo));
+        } else {
+            memcpy(hi, mid, sizeof(hi));
+        }
+    }
+    golden_add_reference(set, lo, CASE_THRESHOLD);
+    golden_add_reference(set, hi, CASE_THRESHOLD);
+}
+
+static void generate_golden(GoldenSet *set, int steps) {
+    // Grade sobre [0, MAX_*]
+    long grid = 1;
+    for (int j = 0; j < INPUT_SIZE; ++j) grid *= steps;
+    for (long n = 0; n < grid; ++n) {
+        float reading[INPUT_SIZE];
+        long k = n;
+        for (int j = 0; j < INPUT_SIZE; ++j, k /= steps) {
+            reading[j] = maxima[j] * (float)(k % steps) / (float)(steps - 1);
+        }
+        golden_add_reference(set, reading, CASE_GRID);
+    }
+
+    // Códigos extremos do ADC, com a mesma conversão de pipeline_acquire
+    static const int32_t codes[] = { 0, 1, ADC_FULL_SCALE / 2, ADC_FULL_SCALE - 1, ADC_FULL_SCALE };
+    const int ncodes = (int)(sizeof(codes) / sizeof(codes[0]));
+    for (int n = 0; n < ncodes * ncodes * ncodes * ncodes; ++n) {
+        float reading[INPUT_SIZE];
+        int k = n;
+        for (int j = 0; j < INPUT_SIZE; ++j, k /= ncodes) {
+            reading[j] = ((float)codes[k % ncodes] / 4095.0f) * maxima[j];
+        }
+        golden_add_reference(set, reading, CASE_ADC);
+    }
+
+    // Fronteiras de classe: segmentos sorteados que cruzam cada limiar
+    static const float thresholds[] = { LIFE_THRESHOLD_MODERATE, LIFE_THRESHOLD_FAVORABLE };
+    for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); ++t) {
+        int pairs = 0;
+        for (long attempt = 0; attempt < THRESHOLD_ATTEMPTS && pairs < THRESHOLD_SEGMENTS; ++attempt) {
+            float a[INPUT_SIZE], b[INPUT_SIZE];
+            random_reading(a);
+            random_reading(b);
+            int a_below = reference_predict(a) < thresholds[t];
+            int b_below = reference_predict(b) < thresholds[t];
+            if (a_below == b_below) {
+                continue;
+            }
+            add_threshold_pair(set, a_below ? a : b, a_below ? b : a, thresholds[t]);
+            pairs++;
+        }
+        if (pairs < THRESHOLD_SEGMENTS) {
+            fprintf(stderr, "Aviso: só %d segmentos cruzam o limiar %.2f\n", pairs, thresholds[t]);
+        }
+    }
+}
+
+static int write_golden(const GoldenSet *set, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    fprintf(file, "categoria,temperatura,umidade,gas,luz,esperado\n");
+    for (size_t n = 0; n < set->count; ++n) {
+        const GoldenVector *v = &set->items[n];
+        // %.9g: o float volta exatamente o mesmo na leitura
+        fprintf(file, "%s,%.9g,%.9g,%.9g,%.9g,%.9g\n", case_names[v->category],
+                v->reading[0], v->reading[1], v->reading[2], v->reading[3], v->expected);
+    }
+    return fclose(file) != 0;
+}
+
+static int read_golden(GoldenSet *set, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    char line[256];
+    size_t number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char name[16];
+        float reading[INPUT_SIZE], expected;
+        number++;
+        if (number == 1 && strncmp(line, "categoria", 9) == 0) {
+            continue;
+        }
+        if (sscanf(line, "%15[^,],%f,%f,%f,%f,%f", name, &reading[0], &reading[1], &reading[2], &reading[3], &expected) != 6) {
+            fprintf(stderr, "%s:%zu: linha inválida\n", path, number);
+            fclose(file);
+            return 1;
+        }
+        int category = 0;
+        while (category < CASE_COUNT && strcmp(name, case_names[category]) != 0) category++;
+        if (category == CASE_COUNT) {
+            fprintf(stderr, "%s:%zu: categoria desconhecida '%s'\n", path, number, name);
+            fclose(file);
+            return 1;
+        }
+        golden_add(set, reading, expected, category);
+    }
+    fclose(file);
+    return 0;
+}
+
+/* ---------------- Conferência ---------------- */
+
+/* Coluna de texto com largura em caracteres (os nomes têm acentos em UTF-8) */
+static void print_padded(const char *text, int width) {
+    int length = 0;
+    for (const char *c = text; *c; ++c) {
+        length += ((unsigned char)*c & 0xC0) != 0x80;
+    }
+    printf("%s%*s", text, width > length ? width - length : 0, "");
+}
+
+static int near_threshold(float expected, float tolerance) {
+    return fabsf(expected - LIFE_THRESHOLD_MODERATE) <= tolerance || fabsf(expected - LIFE_THRESHOLD_FAVORABLE) <= tolerance;
+}
+
+static int check_backend(const Backend *backend, const GoldenSet *set, const float *readings, float *out) {
+    backend->run(readings, out, set->count);
+
+    double sum_error = 0.0;
+    float max_error = 0.0f, case_max[CASE_COUNT] = { 0 };
+    size_t worst = 0, mismatches = 0, excused = 0;
+    for (size_t n = 0; n < set->count; ++n) {
+        const GoldenVector *v = &set->items[n];
+        float error = fabsf(out[n] - v->expected);
+        if (isnan(error)) error = INFINITY;
+        sum_error += error;
+        if (error > case_max[v->category]) case_max[v->category] = error;
+        if (error > max_error) {
+            max_error = error;
+            worst = n;
+        }
+        if (classify(out[n]) != classify(v->expected)) {
+            mismatches++;
+            excused += near_threshold(v->expected, backend->tolerance);
+        }
+    }
+
+    // Vazão: o conjunto inteiro repetido até passar de BENCH_MIN_SAMPLES amostras
+    size_t rounds = (BENCH_MIN_SAMPLES + set->count - 1) / set->count;
+    double start = now_ns();
+    for (size_t r = 0; r < rounds; ++r) {
+        backend->run(readings, out, set->count);
+    }
+    double ns = (now_ns() - start) / (double)(rounds * set->count);
+
+    int failed = max_error > backend->tolerance || mismatches != excused;
+    print_padded(backend->name, 31);
+    printf(" %9.2e %9.2e %9.2e %9.2e %9.2e %8.4f%% %5zu/%-5zu %7.1f  %s\n",
+           max_error, sum_error / (double)set->count, case_max[CASE_GRID], case_max[CASE_ADC], case_max[CASE_THRESHOLD],
+           100.0 * (double)(set->count - mismatches) / (double)set->count, mismatches, excused, ns,
+           failed ? "FALHA" : "OK");
+    if (failed) {
+        const GoldenVector *v = &set->items[worst];
+        printf("    pior caso (%s): [%.9g, %.9g, %.9g, %.9g] esperado %.9g, obtido %.9g\n", case_names[v->category],
+               v->reading[0], v->reading[1], v->reading[2], v->reading[3], v->expected, out[worst]);
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    int steps = DEFAULT_GRID_STEPS;
+    const char *write_path = NULL, *read_path = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            steps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            write_path = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            read_path = argv[++i];
+        } else {
+            fprintf(stderr, "Uso: %s [-g passos] [-w vetores.csv] [-r vetores.csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (steps < 2) {
+        fprintf(stderr, "A grade precisa de ao menos 2 passos por canal.\n");
+        return 2;
+    }
+
+    GoldenSet set = { 0 };
+    if (read_path ? read_golden(&set, read_path) : (generate_golden(&set, steps), 0)) {
+        return 2;
+    }
+    if (set.count == 0) {
+        fprintf(stderr, "Nenhum vetor de referência.\n");
+        return 2;
+    }
+    if (write_path && write_golden(&set, write_path)) {
+        return 2;
+    }
+    size_t per_case[CASE_COUNT] = { 0 };
+    for (size_t n = 0; n < set.count; ++n) per_case[set.items[n].category]++;
+
+    float *readings = malloc(set.count * INPUT_SIZE * sizeof(float));
+    float *out = malloc(set.count * sizeof(float));
+    if (!readings || !out) {
+        perror("malloc");
+        return 2;
+    }
+    for (size_t n = 0; n < set.count; ++n) {
+        memcpy(readings + n * INPUT_SIZE, set.items[n].reading, sizeof(set.items[n].reading));
+    }
+    fixed_init();
+
+    printf("Vetores de referência: %zu (%s%s): grade %zu, adc %zu, limiar %zu\n", set.count,
+           read_path ? "lidos de " : "gerados", read_path ? read_path : "", per_case[CASE_GRID], per_case[CASE_ADC],
+           per_case[CASE_THRESHOLD]);
+    print_padded("Implementação", 31);
+    printf("  erro máx     médio     grade       adc    limiar     classe   diverg/fx  ns/amostra\n");
+    int failed = 0;
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        failed |= check_backend(&backends[b], &set, readings, out);
+    }
+    printf("diverg/fx: divergências de classe / quantas com a referência a menos da tolerância de um limiar\n");
+    printf("Resultado: %s\n", failed ? "FALHA" : "OK");
+
+    free(readings);
+    free(out);
+    free(set.items);
+    return failed;
+}
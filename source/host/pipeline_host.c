@@ -0,0 +1,245 @@
+/*
+* Build de host do pipeline de dois núcleos (pipeline.h), com pthreads no lugar das tarefas do FreeRTOS.
+*
+* Modo padrão: uma thread de aquisição gera códigos de ADC sintéticos e chama pipeline_acquire,
+* como a acquisitionTask do firmware; uma thread de rede consome as amostras, codifica a telemetria
+* (telemetry_codec.h) e devolve comandos toggle_system_state pela fila de comandos; cada comando
+* aplicado volta confirmado pela fila de acks.
+* Modo --stress: martela as filas SPSC com sequências numeradas e verifica ordem e integridade.
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O2 -pthread -DIA_MODEL_NO_EXAMPLE -I../esp32-firmware -I../ia_model -o pipeline_host pipeline_host.c \
+*       ../esp32-firmware/pipeline.c ../esp32-firmware/adaptive_rate.c ../esp32-firmware/telemetry_codec.c \
+*       ../ia_model/ia_model.c ../ia_model/ia_features.c -lm
+*   ./pipeline_host [amostras]
+*   ./pipeline_host --stress [itens]
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pipeline.h"
+#include "telemetry_codec.h"
+
+#define DEFAULT_SAMPLES 1000000UL
+#define DEFAULT_STRESS_ITEMS 20000000UL
+#define COMMAND_EVERY 5000UL          // A rede pede um toggle a cada N amostras
+#define STRESS_QUEUE_SIZE 8           // Fila pequena para maximizar a disputa
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ---------------- Pipeline ---------------- */
+
+static PipelineSample sample_storage[PIPELINE_SAMPLE_QUEUE_SIZE];
+static PipelineCommand command_storage[PIPELINE_COMMAND_QUEUE_SIZE];
+static PipelineAck ack_storage[PIPELINE_ACK_QUEUE_SIZE];
+static SpscQueue sample_queue;
+static SpscQueue command_queue;
+static SpscQueue ack_queue;
+static unsigned long total_samples;
+static int acquisition_done;
+static int pipeline_failed;
+
+/* Equivalente à acquisitionTask: o "relógio" avança 500 ms por ciclo, sem dormir (taxa fixa; a
+* taxa adaptativa é avaliada pelo rate_replay.c) */
+static void *acquisition_thread(void *arg) {
+    AcquisitionState state;
+    RateConfig fixed_rate = { 500, 500, 500, 2.0f, 2.0f, 2.0f, 2.0f, 0.0f, 1 };
+    int32_t code[PIPELINE_CHANNELS] = { 1600, 2600, 900, 2200 };
+    int system_on = 1;
+    unsigned int seed = 1234;
+    (void)arg;
+
+    pipeline_acquisition_init(&state, &fixed_rate, 1000);
+    for (unsigned long i = 0; i < total_samples; ++i) {
+        PipelineSample sample;
+        PipelineCommand command;
+        uint8_t events = 0;
+
+        while (spsc_pop(&command_queue, &command)) {
+            if (command.type == PIPELINE_COMMAND_TOGGLE_SYSTEM) {
+                system_on = !system_on;
+                events |= PIPELINE_EVENT_REMOTE_TOGGLE;
+                PipelineAck ack = { command.id, command.received_ms, i * 500UL, (uint8_t)system_on };
+                spsc_push(&ack_queue, &ack);
+            }
+        }
+        for (int c = 0; c < PIPELINE_CHANNELS; ++c) {
+            code[c] += (int32_t)(rand_r(&seed) % 5) - 2;
+            if (code[c] < 0) code[c] = 0;
+            if (code[c] > CODEC_ADC_FULL_SCALE) code[c] = CODEC_ADC_FULL_SCALE;
+        }
+
+        pipeline_acquire(&state, code, system_on, i * 500UL, &sample);
+        sample.events = events;
+        // No firmware a amostra é descartada com a fila cheia; aqui espera para medir a vazão total
+        while (!spsc_push(&sample_queue, &sample)) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&acquisition_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/* Equivalente à networkTask: consome amostras, codifica a telemetria e envia comandos */
+static void *network_thread(void *arg) {
+    CodecEncoder encoder;
+    uint8_t frame[CODEC_MAX_FRAME];
+    unsigned long received = 0, toggles = 0, out_of_order = 0, bytes = 0;
+    unsigned long last_tick = 0, acks = 0, bad_acks = 0;
+    uint32_t next_command_id = 1, expected_ack_id = 1;
+    (void)arg;
+
+    codec_encoder_init(&encoder);
+    for (;;) {
+        PipelineAck ack;
+        while (spsc_pop(&ack_queue, &ack)) {
+            // Acks chegam na ordem dos comandos e com o estado alternado a cada toggle
+            if (ack.id != expected_ack_id++ || ack.system_on != (acks % 2 == 1)) {
+                bad_acks++;
+            }
+            acks++;
+        }
+
+        PipelineSample sample;
+        if (!spsc_pop(&sample_queue, &sample)) {
+            if (__atomic_load_n(&acquisition_done, __ATOMIC_ACQUIRE) && spsc_size(&sample_queue) == 0) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        if (received > 0 && sample.tick_ms != last_tick + 500UL) {
+            out_of_order++;
+        }
+        last_tick = sample.tick_ms;
+        received++;
+        if (sample.events & PIPELINE_EVENT_REMOTE_TOGGLE) {
+            toggles++;
+        }
+
+        CodecSample encoded;
+        memcpy(encoded.values, sample.raw, sizeof(sample.raw));
+        encoded.values[CODEC_CHANNEL_LIFE] = codec_quantize(sample.life_chance, 1.0f, CODEC_LIFE_SCALE);
+        encoded.flags = (sample.system_on ? CODEC_FLAG_SYSTEM_ON : 0) | (sample.predicted ? CODEC_FLAG_PREDICTED : 0)
+            | (uint8_t)(sample.terrain_class << CODEC_TERRAIN_SHIFT);
+        bytes += codec_encode(&encoder, "RoboExplorador", &encoded, frame, sizeof(frame));
+
+        if (received % COMMAND_EVERY == 0) {
+            PipelineCommand command = { PIPELINE_COMMAND_TOGGLE_SYSTEM, next_command_id, sample.tick_ms };
+            if (spsc_push(&command_queue, &command)) {
+                next_command_id++;
+            }
+        }
+    }
+
+    printf("Amostras recebidas:  %lu de %lu\n", received, total_samples);
+    printf("Fora de ordem:       %lu\n", out_of_order);
+    printf("Toggles aplicados:   %lu (%lu acks, %lu inválidos)\n", toggles, acks, bad_acks);
+    printf("Telemetria:          %.2f bytes/amostra\n", received ? (double)bytes / received : 0.0);
+    pipeline_failed = out_of_order || bad_acks || received != total_samples;
+    return NULL;
+}
+
+static int run_pipeline(unsigned long samples) {
+    pthread_t acquisition, network;
+
+    total_samples = samples;
+    spsc_init(&sample_queue, sample_storage, sizeof(PipelineSample), PIPELINE_SAMPLE_QUEUE_SIZE);
+    spsc_init(&command_queue, command_storage, sizeof(PipelineCommand), PIPELINE_COMMAND_QUEUE_SIZE);
+    spsc_init(&ack_queue, ack_storage, sizeof(PipelineAck), PIPELINE_ACK_QUEUE_SIZE);
+
+    double start = now_s();
+    pthread_create(&network, NULL, network_thread, NULL);
+    pthread_create(&acquisition, NULL, acquisition_thread, NULL);
+    pthread_join(acquisition, NULL);
+    pthread_join(network, NULL);
+    double elapsed = now_s() - start;
+
+    printf("Vazão do pipeline:   %.0f amostras/s (%.2f us/amostra)\n", samples / elapsed, elapsed * 1e6 / samples);
+    printf("Resultado:           %s\n", pipeline_failed ? "FALHA" : "OK");
+    return pipeline_failed;
+}
+
+/* ---------------- Stress das filas ---------------- */
+
+/* Elemento grande o bastante para atravessar várias palavras: detecta leituras rasgadas */
+typedef struct {
+    uint64_t seq;
+    uint64_t check[7];
+} StressItem;
+
+static StressItem stress_storage[STRESS_QUEUE_SIZE];
+static SpscQueue stress_queue;
+static unsigned long stress_items;
+static unsigned long stress_errors;
+
+static void *stress_producer(void *arg) {
+    (void)arg;
+    for (uint64_t seq = 0; seq < stress_items; ++seq) {
+        StressItem item;
+        item.seq = seq;
+        for (int k = 0; k < 7; ++k) item.check[k] = seq * 2654435761u + (uint64_t)k;
+        while (!spsc_push(&stress_queue, &item)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *stress_consumer(void *arg) {
+    unsigned long errors = 0;
+    (void)arg;
+    for (uint64_t expected = 0; expected < stress_items; ) {
+        StressItem item;
+        if (!spsc_pop(&stress_queue, &item)) {
+            sched_yield();
+            continue;
+        }
+        int ok = item.seq == expected;
+        for (int k = 0; k < 7; ++k) ok = ok && item.check[k] == item.seq * 2654435761u + (uint64_t)k;
+        if (!ok) {
+            errors++;
+            expected = item.seq;
+        }
+        expected++;
+    }
+    stress_errors = errors;
+    return NULL;
+}
+
+static int run_stress(unsigned long items) {
+    pthread_t producer, consumer;
+
+    stress_items = items;
+    spsc_init(&stress_queue, stress_storage, sizeof(StressItem), STRESS_QUEUE_SIZE);
+
+    double start = now_s();
+    pthread_create(&consumer, NULL, stress_consumer, NULL);
+    pthread_create(&producer, NULL, stress_producer, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    double elapsed = now_s() - start;
+
+    printf("Itens:               %lu (fila de %d)\n", items, STRESS_QUEUE_SIZE);
+    printf("Vazão da fila:       %.1f M itens/s\n", items / elapsed / 1e6);
+    printf("Pushes recusados:    %u\n", stress_queue.dropped);
+    printf("Erros de ordem/dado: %lu\n", stress_errors);
+    printf("Resultado:           %s\n", stress_errors ? "FALHA" : "OK");
+    return stress_errors ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--stress") == 0) {
+        return run_stress(argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_STRESS_ITEMS);
+    }
+    return run_pipeline(argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SAMPLES);
+}
@@ -0,0 +1,236 @@
+/*
+* Avaliação do controle adaptativo de taxa (adaptive_rate.h) por replay de traces gravados.
+*
+* O trace é lido no mesmo CSV do codec_bench (temperature,humidity,gas,light,life_probability, sem
+* cabeçalho), com uma linha a cada --period ms (padrão 250, o intervalo mínimo do controle).
+* Três estratégias percorrem o mesmo trace com pipeline_acquire, como a acquisitionTask:
+*   referência: lê e prediz em toda linha do trace;
+*   fixa:       SENSOR_READ_INTERVAL / AI_PREDICTION_INTERVAL constantes (500 / 1000 ms);
+*   adaptativa: RATE_CONFIG_DEFAULT(500) com a IA em 1000 ms no intervalo base.
+* Um evento é uma mudança de classe do terreno vista pela referência; a estratégia o detecta se
+* tiver uma predição com a nova classe em até EVENT_TOLERANCE_MS. Sem arquivo, usa um trace
+* sintético com longos trechos estáveis e plumas de gás / mudanças de luz ocasionais.
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O2 -DIA_MODEL_NO_EXAMPLE -I../esp32-firmware -I../ia_model -o rate_replay rate_replay.c \
+*       ../esp32-firmware/pipeline.c ../esp32-firmware/adaptive_rate.c ../esp32-firmware/telemetry_codec.c \
+*       ../ia_model/ia_model.c ../ia_model/ia_features.c -lm
+*   ./rate_replay [--period ms] [trace.csv]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adaptive_rate.h"
+#include "ia_model.h"
+#include "pipeline.h"
+#include "telemetry_codec.h"
+
+#define SENSOR_READ_INTERVAL 500
+#define AI_PREDICTION_INTERVAL 1000
+#define EVENT_TOLERANCE_MS 2000
+#define SYNTHETIC_SAMPLES 200000      // 200000 x 0,25s = ~14h de operação
+
+typedef struct {
+    int32_t raw[PIPELINE_CHANNELS];
+} TraceRow;
+
+/* Resultado de uma estratégia sobre o trace */
+typedef struct {
+    const char *name;
+    unsigned long samples;
+    unsigned long predictions;
+    unsigned long detected;
+    unsigned long missed;
+    unsigned long long delay_ms;       // Soma dos atrasos de detecção
+} ReplayResult;
+
+/* Predição de uma estratégia, para casar com os eventos da referência */
+typedef struct {
+    unsigned long time_ms;
+    uint8_t terrain_class;
+} Prediction;
+
+static size_t load_trace(const char *path, TraceRow **rows) {
+    FILE *file = fopen(path, "r");
+    size_t count = 0, capacity = 1024;
+    char line[256];
+
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    *rows = malloc(capacity * sizeof(TraceRow));
+    while (fgets(line, sizeof(line), file)) {
+        float temp, hum, gas, lux;
+        if (sscanf(line, "%f,%f,%f,%f", &temp, &hum, &gas, &lux) != 4) {
+            continue;   // Linhas com NULL (sistema desligado) ou cabeçalho
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            *rows = realloc(*rows, capacity * sizeof(TraceRow));
+        }
+        TraceRow *row = &(*rows)[count++];
+        row->raw[0] = codec_quantize(temp, MAX_TEMPERATURE_READING, CODEC_ADC_FULL_SCALE);
+        row->raw[1] = codec_quantize(hum, 100.0f, CODEC_ADC_FULL_SCALE);
+        row->raw[2] = codec_quantize(gas, MAX_GAS_READING, CODEC_ADC_FULL_SCALE);
+        row->raw[3] = codec_quantize(lux, MAX_LIGHT_READING, CODEC_ADC_FULL_SCALE);
+    }
+    fclose(file);
+    return count;
+}
+
+/* Terreno estável com ruído de ADC; de tempos em tempos uma pluma de gás (subida rápida e
+* decaimento lento) ou um degrau de luz */
+static size_t synthetic_trace(TraceRow **rows) {
+    int32_t base[PIPELINE_CHANNELS] = { 1600, 2600, 900, 1200 };
+    float plume = 0.0f, plume_target = 0.0f;
+
+    *rows = malloc(SYNTHETIC_SAMPLES * sizeof(TraceRow));
+    srand(7);
+    for (size_t i = 0; i < SYNTHETIC_SAMPLES; ++i) {
+        if (rand() % 4000 == 0) {
+            plume_target = 1500.0f + rand() % 1500;
+        }
+        if (rand() % 6000 == 0) {
+            base[3] = 400 + rand() % 3200;
+        }
+        if (rand() % 16 == 0) {
+            base[0] += rand() % 3 - 1;
+        }
+        // Pluma sobe em ~2s e some em ~15s
+        plume += (plume_target - plume) * (plume_target > plume ? 0.12f : 0.0f);
+        if (plume_target > 0.0f && plume >= plume_target * 0.98f) {
+            plume_target = 0.0f;
+        }
+        if (plume_target == 0.0f) {
+            plume *= 0.984f;
+        }
+        for (int c = 0; c < PIPELINE_CHANNELS; ++c) {
+            int32_t value = base[c] + (c == 2 ? (int32_t)plume : 0) + rand() % 5 - 2;
+            if (value < 0) value = 0;
+            if (value > CODEC_ADC_FULL_SCALE) value = CODEC_ADC_FULL_SCALE;
+            (*rows)[i].raw[c] = value;
+        }
+    }
+    return SYNTHETIC_SAMPLES;
+}
+
+/* Percorre o trace chamando pipeline_acquire quando o intervalo da estratégia vence */
+static size_t replay(const TraceRow *rows, size_t count, unsigned long period_ms, const RateConfig *config,
+                     unsigned long prediction_ms, ReplayResult *result, Prediction *predictions) {
+    AcquisitionState state;
+    unsigned long next_ms = 0;
+    size_t predicted = 0;
+
+    pipeline_acquisition_init(&state, config, prediction_ms);
+    for (size_t i = 0; i < count; ++i) {
+        unsigned long now_ms = (unsigned long)i * period_ms;
+        if (now_ms < next_ms) {
+            continue;
+        }
+        PipelineSample sample;
+        pipeline_acquire(&state, rows[i].raw, 1, now_ms, &sample);
+        result->samples++;
+        if (sample.predicted) {
+            predictions[predicted].time_ms = now_ms;
+            predictions[predicted].terrain_class = sample.terrain_class;
+            predicted++;
+        }
+        next_ms = now_ms + sample.interval_ms;
+    }
+    result->predictions = predicted;
+    return predicted;
+}
+
+/* Casa cada mudança de classe da referência com a primeira predição da estratégia na nova classe */
+static void match_events(const Prediction *reference, size_t reference_count,
+                         const Prediction *predictions, size_t count, ReplayResult *result) {
+    size_t j = 0;
+    for (size_t i = 1; i < reference_count; ++i) {
+        if (reference[i].terrain_class == reference[i - 1].terrain_class) {
+            continue;
+        }
+        unsigned long event_ms = reference[i].time_ms;
+        while (j < count && predictions[j].time_ms < event_ms) {
+            j++;
+        }
+        size_t k = j;
+        while (k < count && predictions[k].time_ms <= event_ms + EVENT_TOLERANCE_MS
+               && predictions[k].terrain_class != reference[i].terrain_class) {
+            k++;
+        }
+        if (k < count && predictions[k].time_ms <= event_ms + EVENT_TOLERANCE_MS) {
+            result->detected++;
+            result->delay_ms += predictions[k].time_ms - event_ms;
+        } else {
+            result->missed++;
+        }
+    }
+}
+
+static void print_result(const ReplayResult *result, const ReplayResult *fixed) {
+    printf("%-11s %10lu %9.1f%% %11lu %9.1f%% %8lu %7lu %9.0f\n", result->name,
+           result->samples, 100.0 * (1.0 - (double)result->samples / fixed->samples),
+           result->predictions, 100.0 * (1.0 - (double)result->predictions / fixed->predictions),
+           result->detected, result->missed,
+           result->detected ? (double)result->delay_ms / result->detected : 0.0);
+}
+
+int main(int argc, char **argv) {
+    unsigned long period_ms = 250;
+    const char *path = NULL;
+    TraceRow *rows;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) {
+            period_ms = strtoul(argv[++i], NULL, 10);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (period_ms == 0) {
+        fprintf(stderr, "--period deve ser maior que zero\n");
+        return 1;
+    }
+    size_t count = path ? load_trace(path, &rows) : synthetic_trace(&rows);
+    if (count == 0) {
+        fprintf(stderr, "Trace vazio.\n");
+        return 1;
+    }
+
+    Prediction *reference = malloc(count * sizeof(Prediction));
+    Prediction *predictions = malloc(count * sizeof(Prediction));
+
+    // Referência: toda linha, sem adaptação (limiares acima de qualquer variação normalizada)
+    RateConfig every_row = { period_ms, period_ms, period_ms, 2.0f, 2.0f, 2.0f, 2.0f, 0.0f, 1 };
+    ReplayResult reference_result = { "referência", 0, 0, 0, 0, 0 };
+    size_t reference_count = replay(rows, count, period_ms, &every_row, period_ms, &reference_result, reference);
+    match_events(reference, reference_count, reference, reference_count, &reference_result);
+
+    RateConfig fixed_config = { SENSOR_READ_INTERVAL, SENSOR_READ_INTERVAL, SENSOR_READ_INTERVAL,
+                                2.0f, 2.0f, 2.0f, 2.0f, 0.0f, 1 };
+    ReplayResult fixed = { "fixa", 0, 0, 0, 0, 0 };
+    size_t fixed_count = replay(rows, count, period_ms, &fixed_config, AI_PREDICTION_INTERVAL, &fixed, predictions);
+    match_events(reference, reference_count, predictions, fixed_count, &fixed);
+
+    RateConfig adaptive_config = RATE_CONFIG_DEFAULT(SENSOR_READ_INTERVAL);
+    ReplayResult adaptive = { "adaptativa", 0, 0, 0, 0, 0 };
+    size_t adaptive_count = replay(rows, count, period_ms, &adaptive_config, AI_PREDICTION_INTERVAL, &adaptive, predictions);
+    match_events(reference, reference_count, predictions, adaptive_count, &adaptive);
+
+    printf("Trace: %zu linhas a cada %lu ms (%.1f h), %s\n", count, period_ms,
+           count * period_ms / 3.6e6, path ? path : "sintético");
+    printf("Tolerância de detecção: %d ms\n\n", EVENT_TOLERANCE_MS);
+    printf("%-11s %10s %10s %11s %10s %8s %7s %9s\n", "estratégia", "leituras", "economia",
+           "predições", "economia", "eventos", "perdas", "atraso ms");
+    print_result(&reference_result, &fixed);
+    print_result(&fixed, &fixed);
+    print_result(&adaptive, &fixed);
+
+    free(reference);
+    free(predictions);
+    free(rows);
+    return 0;
+}
@@ -0,0 +1,126 @@
+"""
+Benchmark da pontuação no servidor: linhas/s pelo binding ctypes do broker (libia_model.so, ver
+source/ia_model/ia_model_lib.h) contra o mesmo forward pass escrito em Python puro.
+
+Sobe o broker no próprio processo (portas livres, banco num diretório temporário), gera linhas no
+formato da tupla de sensor_data da fila de gravação e mede, para cada tamanho de lote:
+- python:  forward pass linha a linha, com os pesos lidos de ia_model.h (gen_model.load_model);
+- binding: Broker.score_rows, o caminho da thread de gravação (empacotar as leituras, uma chamada
+  nativa por lote, concordância por dispositivo e tuplas com a chance do servidor);
+- nativo:  só a chamada ia_model_score_batch sobre leituras já empacotadas.
+Confere também a maior diferença entre a chance do Python (float64) e a da biblioteca (float32).
+
+Executar (a partir de source/host, com as dependências do broker instaladas e a biblioteca compilada
+conforme ia_model_lib.h):
+    python3 score_binding_bench.py [--rows 200000] [--batches 1,16,500,50000]
+"""
+
+import argparse
+import math
+import os
+import random
+import socket
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE_DIR = os.path.join(HERE, '..', 'esp32-firmware')
+MODEL_DIR = os.path.join(HERE, '..', 'ia_model')
+
+
+def free_port(kind):
+    with socket.socket(socket.AF_INET, kind) as sock:
+        sock.bind(('127.0.0.1', 0))
+        return sock.getsockname()[1]
+
+
+def python_model():
+    """Forward pass em Python puro com os pesos de ia_model.h: leituras físicas -> chance de vida."""
+    sys.path.insert(0, MODEL_DIR)
+    import gen_model
+    header = os.path.join(MODEL_DIR, 'ia_model.h')
+    with open(header) as f:
+        W1, b1, W2, b2, _, maxima = gen_model.load_model(header, f.read())
+    columns = [[row[i] for row in W1] for i in range(len(b1))]   # Pesos de cada unidade oculta
+
+    def predict(readings):
+        x = [value / maximum for value, maximum in zip(readings, maxima)]
+        output = b2
+        for weights, bias, w2 in zip(columns, b1, W2):
+            hidden = bias + sum(xj * wj for xj, wj in zip(x, weights))
+            if hidden > 0:
+                output += hidden * w2
+        return 1.0 / (1.0 + math.exp(-output))
+    return predict, maxima
+
+
+def make_rows(count, maxima):
+    """Tuplas como as de store_sensor_data: (nome, temp, umid, gás, luz, chance, terreno, foto, captura, recebimento)."""
+    rng = random.Random(41)
+    rows = []
+    for i in range(count):
+        readings = [rng.uniform(0.0, maximum) for maximum in maxima]
+        rows.append((f"robo{i % 100:03d}", *readings, rng.random(), "Condição Moderada 🟨", None, None, time.time()))
+    return rows
+
+
+def rate(rows, seconds):
+    return f"{rows / seconds:>12,.0f}" if seconds > 0 else f"{'-':>12}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Linhas/s pelo binding nativo contra o forward pass em Python")
+    parser.add_argument('--rows', type=int, default=200000)
+    parser.add_argument('--batches', default="1,16,500,50000", help="tamanhos de lote separados por vírgula")
+    args = parser.parse_args()
+    batches = [int(b) for b in args.batches.split(',')]
+
+    workdir = tempfile.mkdtemp(prefix='score_bench_')
+    os.environ.update(BROKER_DB=os.path.join(workdir, 'bench.db'), BROKER_PHOTOS_DIR=os.path.join(workdir, 'photos'),
+                      BROKER_ARCHIVE_DIR=os.path.join(workdir, 'archive'),
+                      BROKER_COMMAND_PORT=str(free_port(socket.SOCK_STREAM)),
+                      BROKER_DATA_PORT=str(free_port(socket.SOCK_DGRAM)))
+    sys.path.insert(0, FIRMWARE_DIR)
+    import logging
+    import broker as broker_module
+    logging.getLogger().setLevel(logging.WARNING)
+    broker = broker_module.broker
+    scorer = broker.scorer
+    if scorer.library is None:
+        sys.exit(f"Biblioteca '{scorer.path}' indisponível: compile-a conforme source/ia_model/ia_model_lib.h.")
+
+    predict, maxima = python_model()
+    rows = make_rows(args.rows, maxima)
+    inputs, _ = broker_module.SCORED_INSERTS[broker_module.SQL_INSERT_SENSOR_DATA]
+
+    start = time.perf_counter()
+    expected = [predict([values[i] for i in inputs]) for values in rows]
+    python_s = time.perf_counter() - start
+
+    print(f"Modelo:   {scorer.path} (pesos {scorer.fingerprint}), {args.rows} linhas")
+    print(f"{'lote':>8} {'python/s':>12} {'binding/s':>12} {'nativo/s':>12} {'binding/python':>15}")
+    worst = 0.0
+    for size in batches:
+        # Binding: o caminho completo da thread de gravação
+        start = time.perf_counter()
+        scored = []
+        for first in range(0, len(rows), size):
+            chunk = rows[first:first + size]
+            scored.extend(broker.score_rows(broker_module.SQL_INSERT_SENSOR_DATA, chunk, [True] * len(chunk)))
+        binding_s = time.perf_counter() - start
+        worst = max(worst, max(abs(values[-1] - p) for values, p in zip(scored, expected)))
+
+        # Nativo: só a chamada, com as leituras já empacotadas
+        packed = [scorer.pack(rows[first:first + size], inputs) for first in range(0, len(rows), size)]
+        start = time.perf_counter()
+        for readings in packed:
+            scorer.score(readings)
+        native_s = time.perf_counter() - start
+        print(f"{size:>8} {rate(len(rows), python_s)} {rate(len(rows), binding_s)} {rate(len(rows), native_s)} "
+              f"{python_s / binding_s:>14.1f}x")
+    print(f"Diferença máxima python x nativo: {worst:.2e} (float64 x float32)")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,326 @@
+/*
+* Reavaliação em lote do histórico de sensores com o modelo atual (ia_model.h).
+*
+* Entrada (mapeada em memória, nunca carregada inteira):
+*   - CSV com temperature,humidity,gas,light por linha (cabeçalho opcional), exportado com:
+*       sqlite3 -csv planet_exploration.db "SELECT temperature, humidity, gas, light FROM sensor_data ORDER BY id" > historico.csv
+*   - binário (-f bin): float32 little-endian, 4 por linha, na mesma ordem. As linhas antigas já
+*     seladas pelo broker no arquivo colunar saem nesse formato com 'archive_scan --export'.
+* A entrada é dividida em fatias entre as threads; cada uma usa model_predict_batch e escreve
+* direto na sua região do arquivo de saída, também mapeado.
+*
+* Saída colunar:
+*   [cabeçalho de 32 bytes: "LIFESCR1", uint64 linhas, uint64 offset das chances, uint64 offset das classes]
+*   [float32 chance de vida x linhas][uint8 classe x linhas]
+* Classes com os limiares do loop(): 0 hostil (< 0.5), 1 moderado (>= 0.5), 2 propício (>= 0.70),
+* SCORE_LABEL_INVALID para linhas que não puderam ser lidas (chance NaN).
+*
+* Compilar e executar (a partir de source/host):
+*   gcc -O3 -pthread -DIA_MODEL_NO_EXAMPLE -I../ia_model -o score_history score_history.c \
+*       ../ia_model/ia_model.c ../ia_model/ia_features.c -lm
+*   ./score_history [-t threads] [-f csv|bin] historico.csv scores.bin
+*/
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ia_model.h"
+
+#define SCORE_MAGIC "LIFESCR1"
+#define SCORE_HEADER_SIZE 32
+#define SCORE_LABEL_HOSTILE 0
+#define SCORE_LABEL_MODERATE 1
+#define SCORE_LABEL_FAVORABLE 2
+#define SCORE_LABEL_INVALID 255
+#define MAX_THREADS 256
+#define CSV_BATCH_ROWS 4096
+
+typedef struct {
+    // Entrada
+    const char *begin;
+    const char *end;
+    size_t first_row;
+    size_t rows;
+    float *readings;        // Bloco de leituras do CSV (alocado antes de criar as threads)
+    // Saída
+    float *scores;
+    uint8_t *labels;
+} Shard;
+
+static uint8_t classify(float chance) {
+    if (isnan(chance)) return SCORE_LABEL_INVALID;
+    if (chance >= LIFE_THRESHOLD_FAVORABLE) return SCORE_LABEL_FAVORABLE;
+    if (chance >= LIFE_THRESHOLD_MODERATE) return SCORE_LABEL_MODERATE;
+    return SCORE_LABEL_HOSTILE;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ---------------- CSV ---------------- */
+
+static const char *next_line(const char *p, const char *end) {
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return newline ? newline + 1 : end;
+}
+
+/* Conversão de decimal sem depender de terminador nulo (o arquivo mapeado não tem) */
+static const char *parse_float(const char *p, const char *end, float *value) {
+    double result = 0.0, scale = 1.0;
+    int negative = 0, digits = 0;
+
+    while (p < end && (*p == ' ' || *p == '"')) p++;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10.0 + (*p++ - '0');
+        digits++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            scale *= 0.1;
+            result += (*p++ - '0') * scale;
+            digits++;
+        }
+    }
+    if (digits && p < end && (*p == 'e' || *p == 'E')) {
+        int exp_negative = 0, exponent = 0;
+        p++;
+        if (p < end && (*p == '-' || *p == '+')) exp_negative = *p++ == '-';
+        while (p < end && *p >= '0' && *p <= '9') exponent = exponent * 10 + (*p++ - '0');
+        result *= pow(10.0, exp_negative ? -exponent : exponent);
+    }
+    while (p < end && (*p == ' ' || *p == '"')) p++;
+    if (!digits) {
+        return NULL;
+    }
+    *value = (float)(negative ? -result : result);
+    return p;
+}
+
+/* Lê uma linha; retorna 0 se algum campo estiver vazio (NULL no SQLite) ou malformado */
+static int parse_row(const char *p, const char *line_end, float row[INPUT_SIZE]) {
+    for (int j = 0; j < INPUT_SIZE; ++j) {
+        p = parse_float(p, line_end, &row[j]);
+        if (!p) return 0;
+        if (j < INPUT_SIZE - 1) {
+            if (p >= line_end || *p != ',') return 0;
+            p++;
+        }
+    }
+    return 1;
+}
+
+static int is_blank_line(const char *p, const char *line_end) {
+    return line_end - p == 0 || (line_end - p == 1 && *p == '\n')
+        || (line_end - p == 2 && p[0] == '\r' && p[1] == '\n');
+}
+
+/* Passo 1: conta as linhas da fatia */
+static void *csv_count_rows(void *arg) {
+    Shard *shard = arg;
+    size_t rows = 0;
+    for (const char *p = shard->begin; p < shard->end; ) {
+        const char *line_end = next_line(p, shard->end);
+        if (!is_blank_line(p, line_end)) rows++;
+        p = line_end;
+    }
+    shard->rows = rows;
+    return NULL;
+}
+
+/* Prediz um bloco lido e escreve chances e classes a partir da linha 'row' */
+static void csv_flush(Shard *shard, const float *readings, const uint8_t *valid, size_t row, size_t count) {
+    model_predict_batch(readings, &shard->scores[row], count);
+    for (size_t r = 0; r < count; ++r) {
+        if (!valid[r]) shard->scores[row + r] = NAN;
+        shard->labels[row + r] = classify(shard->scores[row + r]);
+    }
+}
+
+/* Passo 2: lê em blocos, prediz e escreve na região da fatia */
+static void *csv_score(void *arg) {
+    Shard *shard = arg;
+    float *readings = shard->readings;
+    uint8_t valid[CSV_BATCH_ROWS];
+    size_t row = shard->first_row;
+    size_t pending = 0;
+
+    for (const char *p = shard->begin; p < shard->end; ) {
+        const char *line_end = next_line(p, shard->end);
+        if (!is_blank_line(p, line_end)) {
+            float *reading = &readings[pending * INPUT_SIZE];
+            valid[pending] = (uint8_t)parse_row(p, line_end, reading);
+            if (!valid[pending]) memset(reading, 0, INPUT_SIZE * sizeof(float));
+            if (++pending == CSV_BATCH_ROWS) {
+                csv_flush(shard, readings, valid, row, pending);
+                row += pending;
+                pending = 0;
+            }
+        }
+        p = line_end;
+    }
+    if (pending) {
+        csv_flush(shard, readings, valid, row, pending);
+    }
+    return NULL;
+}
+
+/* ---------------- Binário ---------------- */
+
+static void *binary_score(void *arg) {
+    Shard *shard = arg;
+    const float *readings = (const float *)shard->begin;
+    // Blocos para que chances e classes do mesmo trecho ainda estejam em cache
+    for (size_t start = 0; start < shard->rows; start += CSV_BATCH_ROWS) {
+        size_t n = shard->rows - start < CSV_BATCH_ROWS ? shard->rows - start : CSV_BATCH_ROWS;
+        float *scores = &shard->scores[shard->first_row + start];
+        model_predict_batch(&readings[start * INPUT_SIZE], scores, n);
+        for (size_t r = 0; r < n; ++r) {
+            const float *reading = &readings[(start + r) * INPUT_SIZE];
+            for (int j = 0; j < INPUT_SIZE; ++j) {
+                if (!isfinite(reading[j])) scores[r] = NAN;
+            }
+            shard->labels[shard->first_row + start + r] = classify(scores[r]);
+        }
+    }
+    return NULL;
+}
+
+/* ---------------- Principal ---------------- */
+
+static void run_threads(void *(*fn)(void *), Shard *shards, int count) {
+    pthread_t threads[MAX_THREADS];
+    for (int t = 0; t < count; ++t) pthread_create(&threads[t], NULL, fn, &shards[t]);
+    for (int t = 0; t < count; ++t) pthread_join(threads[t], NULL);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Uso: %s [-t threads] [-f csv|bin] entrada saida\n", program);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int binary = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:f:")) != -1) {
+        if (opt == 't') threads = atoi(optarg);
+        else if (opt == 'f') binary = strcmp(optarg, "bin") == 0;
+        else usage(argv[0]);
+    }
+    if (argc - optind != 2) usage(argv[0]);
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    // Entrada mapeada somente leitura
+    int in_fd = open(argv[optind], O_RDONLY);
+    struct stat st;
+    if (in_fd < 0 || fstat(in_fd, &st) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+    size_t in_size = (size_t)st.st_size;
+    const char *input = in_size ? mmap(NULL, in_size, PROT_READ, MAP_PRIVATE, in_fd, 0) : NULL;
+    if (in_size && input == MAP_FAILED) {
+        perror("mmap entrada");
+        return 1;
+    }
+    if (input) madvise((void *)input, in_size, MADV_SEQUENTIAL);
+
+    double start = now_s();
+    Shard shards[MAX_THREADS];
+    size_t total_rows = 0;
+    memset(shards, 0, sizeof(shards));
+
+    if (binary) {
+        size_t row_size = INPUT_SIZE * sizeof(float);
+        total_rows = in_size / row_size;
+        if (in_size % row_size != 0) {
+            fprintf(stderr, "%s: %zu bytes no fim não formam uma linha (%zu bytes por linha) e foram ignorados\n",
+                    argv[optind], in_size % row_size, row_size);
+        }
+        for (int t = 0; t < threads; ++t) {
+            size_t first = total_rows * (size_t)t / (size_t)threads;
+            size_t last = total_rows * (size_t)(t + 1) / (size_t)threads;
+            shards[t].begin = input + first * row_size;
+            shards[t].first_row = first;
+            shards[t].rows = last - first;
+        }
+    } else {
+        // Pula o cabeçalho, se houver, e corta as fatias em quebras de linha
+        const char *data = input, *end = input + in_size;
+        if (in_size && ((*data >= 'a' && *data <= 'z') || (*data >= 'A' && *data <= 'Z'))) {
+            data = next_line(data, end);
+        }
+        const char *cursor = data;
+        for (int t = 0; t < threads; ++t) {
+            const char *cut = data + (size_t)(end - data) * (size_t)(t + 1) / (size_t)threads;
+            if (cut < cursor) cut = cursor;
+            if (t < threads - 1 && cut > data && cut < end && cut[-1] != '\n') cut = next_line(cut, end);
+            if (t == threads - 1) cut = end;
+            shards[t].begin = cursor;
+            shards[t].end = cut;
+            cursor = cut;
+        }
+        run_threads(csv_count_rows, shards, threads);
+        for (int t = 0; t < threads; ++t) {
+            shards[t].first_row = total_rows;
+            total_rows += shards[t].rows;
+            shards[t].readings = malloc(CSV_BATCH_ROWS * INPUT_SIZE * sizeof(float));
+            if (!shards[t].readings) {
+                perror("malloc");
+                return 1;
+            }
+        }
+    }
+
+    // Saída colunar mapeada com o tamanho final
+    uint64_t scores_offset = SCORE_HEADER_SIZE;
+    uint64_t labels_offset = scores_offset + total_rows * sizeof(float);
+    size_t out_size = (size_t)(labels_offset + total_rows);
+    int out_fd = open(argv[optind + 1], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0 || ftruncate(out_fd, (off_t)out_size) < 0) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    uint8_t *output = mmap(NULL, out_size, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0);
+    if (output == MAP_FAILED) {
+        perror("mmap saída");
+        return 1;
+    }
+    uint64_t header[3] = { total_rows, scores_offset, labels_offset };
+    memcpy(output, SCORE_MAGIC, 8);
+    memcpy(output + 8, header, sizeof(header));
+
+    for (int t = 0; t < threads; ++t) {
+        shards[t].scores = (float *)(output + scores_offset);
+        shards[t].labels = output + labels_offset;
+    }
+    run_threads(binary ? binary_score : csv_score, shards, threads);
+
+    munmap(output, out_size);
+    close(out_fd);
+    double elapsed = now_s() - start;
+
+    if (input) munmap((void *)input, in_size);
+    close(in_fd);
+    for (int t = 0; t < threads; ++t) free(shards[t].readings);
+
+    fprintf(stderr, "%zu linhas em %.3f s com %d threads: %.0f linhas/s\n",
+            total_rows, elapsed, threads, elapsed > 0 ? total_rows / elapsed : 0.0);
+    return 0;
+}
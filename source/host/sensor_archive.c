@@ -0,0 +1,211 @@
+#include "sensor_archive.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+static const uint8_t column_width[ARCHIVE_COLUMNS] = { 8, 2, 4, 4, 4, 4, 4 };
+
+
+/* Confere cabeçalho, diretório e limites de todos os pedaços: depois disso as leituras não
+* precisam validar nada. Retorna 0 se o segmento for válido. */
+static int archive_validate(Archive *archive, const char *path) {
+    const ArchiveHeader *header = archive->header;
+    if (archive->size < sizeof(ArchiveHeader) || memcmp(header->magic, ARCHIVE_MAGIC, 8) != 0) {
+        fprintf(stderr, "%s: não é um segmento do arquivo colunar\n", path);
+        return -1;
+    }
+    if (header->version != ARCHIVE_VERSION || header->columns != ARCHIVE_COLUMNS
+        || header->block_rows == 0 || header->block_rows > ARCHIVE_MAX_BLOCK_ROWS) {
+        fprintf(stderr, "%s: versão ou layout não suportado\n", path);
+        return -1;
+    }
+    if (header->directory_offset % 8 != 0 || header->directory_offset > archive->size
+        || (archive->size - header->directory_offset) / sizeof(ArchiveBlock) < header->blocks) {
+        fprintf(stderr, "%s: diretório fora do arquivo\n", path);
+        return -1;
+    }
+    uint64_t rows = 0;
+    for (uint32_t b = 0; b < header->blocks; ++b) {
+        const ArchiveBlock *block = &archive->blocks[b];
+        if (block->rows == 0 || block->rows > header->block_rows) {
+            fprintf(stderr, "%s: bloco %u com %u linhas\n", path, b, block->rows);
+            return -1;
+        }
+        rows += block->rows;
+        for (int c = 0; c < ARCHIVE_COLUMNS; ++c) {
+            const ArchiveChunk *chunk = &block->chunks[c];
+            int bad = chunk->width != column_width[c] || chunk->offset > archive->size
+                      || chunk->size > archive->size - chunk->offset || chunk->encoding > ARCHIVE_DELTA_SHUFFLE_ZLIB;
+            // O prefixo das diferenças soma int64 no lugar: só a coluna de tempo (8 bytes) usa delta
+            bad |= chunk->encoding == ARCHIVE_DELTA_SHUFFLE_ZLIB && c != ARCHIVE_COL_TIME;
+            if (chunk->encoding == ARCHIVE_RAW) {
+                // Lido no lugar: precisa do tamanho exato e do alinhamento do tipo
+                bad |= chunk->size != (uint64_t)block->rows * chunk->width || chunk->offset % chunk->width != 0;
+            }
+            if (bad) {
+                fprintf(stderr, "%s: pedaço inválido (bloco %u, coluna %d)\n", path, b, c);
+                return -1;
+            }
+        }
+    }
+    if (rows != header->rows) {
+        fprintf(stderr, "%s: %llu linhas nos blocos, %llu no cabeçalho\n", path,
+                (unsigned long long)rows, (unsigned long long)header->rows);
+        return -1;
+    }
+    return 0;
+}
+
+/* Tabela de nomes: copiada uma vez para strings terminadas em '\0' */
+static int archive_load_names(Archive *archive, const char *path) {
+    const ArchiveHeader *header = archive->header;
+    size_t pos = header->names_offset;
+    archive->names = calloc(header->names_count ? header->names_count : 1, sizeof(char *));
+    archive->name_storage = malloc((size_t)header->names_count * 256 + 1);
+    if (!archive->names || !archive->name_storage) {
+        perror("malloc");
+        return -1;
+    }
+    size_t used = 0;
+    for (uint32_t n = 0; n < header->names_count; ++n) {
+        if (pos >= archive->size || archive->base[pos] > archive->size - pos - 1) {
+            fprintf(stderr, "%s: tabela de nomes fora do arquivo\n", path);
+            return -1;
+        }
+        size_t length = archive->base[pos++];
+        memcpy(archive->name_storage + used, archive->base + pos, length);
+        archive->name_storage[used + length] = '\0';
+        archive->names[n] = archive->name_storage + used;
+        used += length + 1;
+        pos += length;
+    }
+    return 0;
+}
+
+int archive_open(Archive *archive, const char *path) {
+    struct stat info;
+    memset(archive, 0, sizeof(*archive));
+    archive->fd = open(path, O_RDONLY);
+    if (archive->fd < 0 || fstat(archive->fd, &info) != 0) {
+        perror(path);
+        archive_close(archive);
+        return -1;
+    }
+    archive->size = (size_t)info.st_size;
+    if (archive->size < sizeof(ArchiveHeader)) {
+        fprintf(stderr, "%s: arquivo curto demais\n", path);
+        archive_close(archive);
+        return -1;
+    }
+    void *map = mmap(NULL, archive->size, PROT_READ, MAP_SHARED, archive->fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        archive_close(archive);
+        return -1;
+    }
+    archive->base = map;
+    archive->header = (const ArchiveHeader *)archive->base;
+    archive->blocks = (const ArchiveBlock *)(archive->base + archive->header->directory_offset);
+    if (archive_validate(archive, path) != 0 || archive_load_names(archive, path) != 0) {
+        archive_close(archive);
+        return -1;
+    }
+    // As consultas costumam ir bloco a bloco do início ao fim
+    madvise(map, archive->size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void archive_close(Archive *archive) {
+    if (archive->base) {
+        munmap((void *)archive->base, archive->size);
+    }
+    if (archive->fd >= 0) {
+        close(archive->fd);
+    }
+    free(archive->names);
+    free(archive->name_storage);
+    memset(archive, 0, sizeof(*archive));
+    archive->fd = -1;
+}
+
+int archive_scratch_init(ArchiveScratch *scratch, const Archive *archive) {
+    size_t rows = archive->header->block_rows;
+    memset(scratch, 0, sizeof(*scratch));
+    scratch->packed = malloc(rows * 8);
+    int failed = !scratch->packed;
+    for (int c = 0; c < ARCHIVE_COLUMNS; ++c) {
+        scratch->values[c] = malloc(rows * column_width[c]);
+        failed |= !scratch->values[c];
+    }
+    if (failed) {
+        archive_scratch_free(scratch);
+        return -1;
+    }
+    return 0;
+}
+
+void archive_scratch_free(ArchiveScratch *scratch) {
+    free(scratch->packed);
+    for (int c = 0; c < ARCHIVE_COLUMNS; ++c) {
+        free(scratch->values[c]);
+    }
+    memset(scratch, 0, sizeof(*scratch));
+}
+
+/* Zone map: 1 se o bloco pode ter valores da coluna em [low, high] */
+int archive_block_overlaps(const Archive *archive, uint32_t block, int column, double low, double high) {
+    const ArchiveChunk *chunk = &archive->blocks[block].chunks[column];
+    if (isnan(chunk->min)) {
+        return 0;
+    }
+    return chunk->max >= low && chunk->min <= high;
+}
+
+/* Valores de uma coluna de um bloco (rows x largura da coluna). Sem compressão, aponta direto para o
+* mapeamento; comprimido, expande em scratch->values[column]. Retorna NULL se o pedaço estiver corrompido. */
+const void *archive_column(const Archive *archive, uint32_t block, int column, ArchiveScratch *scratch) {
+    const ArchiveBlock *entry = &archive->blocks[block];
+    const ArchiveChunk *chunk = &entry->chunks[column];
+    if (chunk->encoding == ARCHIVE_RAW) {
+        return archive->base + chunk->offset;
+    }
+
+    size_t rows = entry->rows, width = chunk->width;
+    uLongf length = (uLongf)(rows * width);
+    if (uncompress(scratch->packed, &length, archive->base + chunk->offset, chunk->size) != Z_OK
+        || length != rows * width) {
+        return NULL;
+    }
+    // Desfaz o agrupamento: o byte k de cada valor estava no plano k
+    uint8_t *values = scratch->values[column];
+    for (size_t k = 0; k < width; ++k) {
+        const uint8_t *plane = scratch->packed + k * rows;
+        for (size_t r = 0; r < rows; ++r) {
+            values[r * width + k] = plane[r];
+        }
+    }
+    if (chunk->encoding == ARCHIVE_DELTA_SHUFFLE_ZLIB) {
+        int64_t *series = (int64_t *)values;
+        for (size_t r = 1; r < rows; ++r) {
+            series[r] += series[r - 1];
+        }
+    }
+    return values;
+}
+
+/* Índice do dispositivo na tabela de nomes do segmento, ou -1 se ele não aparece ali */
+int archive_device_index(const Archive *archive, const char *name) {
+    for (uint32_t n = 0; n < archive->header->names_count; ++n) {
+        if (strcmp(archive->names[n], name) == 0) {
+            return (int)n;
+        }
+    }
+    return -1;
+}
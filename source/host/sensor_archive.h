@@ -0,0 +1,120 @@
+/*
+* Leitor do arquivo colunar de sensor_data (segmentos .col gravados pelo broker).
+*
+* O broker sela periodicamente as linhas antigas da tabela sensor_data em segmentos imutáveis, um
+* arquivo por faixa de ids; a tabela quente fica pequena e a retenção é apagar arquivos. Cada
+* segmento guarda as colunas em blocos de até block_rows linhas, com largura fixa por canal, e um
+* diretório com, para cada bloco e coluna, onde está o pedaço, a codificação e o mínimo/máximo
+* (zone map). Uma consulta por intervalo de tempo, dispositivo ou limiar lê só o diretório para
+* descartar os blocos que não podem ter linhas e descomprime só os pedaços dos blocos restantes.
+*
+* O arquivo é mapeado em memória (mmap): cabeçalho e diretório são lidos no lugar, sem cópia, assim
+* como os pedaços gravados sem compressão; os comprimidos são expandidos num buffer do chamador.
+*
+* Formato (inteiros little-endian, alinhado a 8 bytes):
+*   [cabeçalho ArchiveHeader][pedaços de dados...][nomes][diretório: blocks x ArchiveBlock]
+*   colunas: tempo (int64, ms Unix), dispositivo (uint16, índice na tabela de nomes) e temperatura,
+*   umidade, gás, luz, chance de vida (float32; NaN onde o banco tinha NULL);
+*   nomes: names_count x [tamanho u8][bytes];
+*   codificações: ARCHIVE_RAW (valores como estão), ARCHIVE_SHUFFLE_ZLIB (bytes de mesma ordem
+*   agrupados e comprimidos com zlib), ARCHIVE_DELTA_SHUFFLE_ZLIB (diferença para o valor anterior
+*   do bloco antes do agrupamento; usada no tempo).
+* A mesma descrição está em broker.py (ColumnarArchive), que grava os segmentos.
+*/
+
+#ifndef SENSOR_ARCHIVE_H
+#define SENSOR_ARCHIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARCHIVE_MAGIC "SNSCOL01"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_MAX_BLOCK_ROWS 65536
+
+enum {
+    ARCHIVE_COL_TIME,
+    ARCHIVE_COL_DEVICE,
+    ARCHIVE_COL_TEMPERATURE,
+    ARCHIVE_COL_HUMIDITY,
+    ARCHIVE_COL_GAS,
+    ARCHIVE_COL_LIGHT,
+    ARCHIVE_COL_LIFE,
+    ARCHIVE_COLUMNS
+};
+
+enum {
+    ARCHIVE_RAW,
+    ARCHIVE_SHUFFLE_ZLIB,
+    ARCHIVE_DELTA_SHUFFLE_ZLIB
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint32_t block_rows;
+    uint32_t blocks;
+    uint64_t rows;
+    int64_t first_id;               // Faixa de ids do SQLite selada neste segmento
+    int64_t last_id;
+    int64_t min_time_ms;
+    int64_t max_time_ms;
+    uint64_t directory_offset;
+    uint64_t names_offset;
+    uint32_t names_count;
+    uint32_t reserved0;
+    uint64_t reserved1;
+} ArchiveHeader;                    // 96 bytes
+
+typedef struct {
+    uint64_t offset;
+    uint32_t size;                  // Bytes gravados (comprimidos ou não)
+    uint8_t encoding;
+    uint8_t width;                  // Bytes por valor
+    uint16_t reserved;
+    double min;                     // Zone map; NaN se o bloco só tem NULL nesta coluna
+    double max;
+} ArchiveChunk;                     // 32 bytes
+
+typedef struct {
+    uint32_t rows;
+    uint32_t reserved;
+    ArchiveChunk chunks[ARCHIVE_COLUMNS];
+} ArchiveBlock;
+
+typedef struct {
+    int fd;
+    const uint8_t *base;
+    size_t size;
+    const ArchiveHeader *header;
+    const ArchiveBlock *blocks;
+    const char **names;             // names_count nomes, terminados em '\0' em 'name_storage'
+    char *name_storage;
+} Archive;
+
+/* Buffers de trabalho para os pedaços comprimidos (um por thread) */
+typedef struct {
+    uint8_t *packed;
+    uint8_t *values[ARCHIVE_COLUMNS];
+} ArchiveScratch;
+
+/* Prototipo de funções*/
+int archive_open(Archive *archive, const char *path);
+void archive_close(Archive *archive);
+int archive_scratch_init(ArchiveScratch *scratch, const Archive *archive);
+void archive_scratch_free(ArchiveScratch *scratch);
+
+int archive_block_overlaps(const Archive *archive, uint32_t block, int column, double low, double high);
+const void *archive_column(const Archive *archive, uint32_t block, int column, ArchiveScratch *scratch);
+int archive_device_index(const Archive *archive, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_ARCHIVE_H
@@ -0,0 +1,366 @@
+"""
+Gerador de código C especializado para a rede 4x8x1 do ia_model.h.
+
+Lê os pesos treinados (do próprio ia_model.h ou de um JSON exportado do Colab) e gera um header
+com a predição em linha reta, sem laços:
+- a normalização (divisão pelos MAX_*) é dobrada nos pesos da camada oculta, então a função
+  recebe as leituras físicas direto;
+- pesos cuja contribuição máxima na faixa válida fica abaixo da tolerância são descartados;
+- unidades ocultas cuja ReLU nunca ativa com as leituras em [0, MAX_*] são eliminadas, e as que
+  sempre ativam viram termos lineares somados na saída (sem o teste da ReLU);
+- um auto-teste opcional (IA_MODEL_GEN_SELF_CHECK) compara com normalize_readings + model_predict_ext
+  numa grade sobre a faixa válida.
+
+Uso (a partir de source/ia_model):
+    python3 gen_model.py                          # ia_model.h -> ia_model_gen.h
+    python3 gen_model.py pesos.json --check       # pesos.json -> ia_model.h e ia_model_gen.h, auto-teste com o gcc
+    python3 gen_model.py pesos.json --keep-header # só ia_model_gen.h (ia_model.h fica com os pesos antigos)
+
+Com um JSON, o bloco de pesos de ia_model.h é reescrito junto: model_predict (/sensores),
+libia_model.so do broker e model_conformance usam o mesmo modelo que o pipeline. Depois do retreino,
+recompile a biblioteca (ia_model_lib.h) e rode o model_conformance. O auto-teste compara sempre com a
+referência compilada a partir dos mesmos pesos do header gerado.
+
+JSON exportado no Colab (Dense ocultas + Dense saída do Keras):
+    W1, b1 = model.layers[0].get_weights(); W2, b2 = model.layers[1].get_weights()
+    json.dump({"W1": W1.tolist(), "b1": b1.tolist(), "W2": W2.ravel().tolist(), "b2": float(b2[0])}, f)
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+INPUT_SIZE = 4
+FEATURE_SIZE = 24  # ia_features.h: 4 canais x 2 janelas x 3 características
+# Faixa física de cada entrada, na ordem de normalize_readings (umidade já é em %)
+INPUT_NAMES = ('temp', 'hum', 'gas', 'lux')
+INPUT_MAX_MACROS = ('MAX_TEMPERATURE_READING', None, 'MAX_GAS_READING', 'MAX_LIGHT_READING')
+HUMIDITY_MAX = 100.0
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def parse_numbers(text):
+    return [float(n) for n in re.findall(r'[-+]?(?:\d+\.\d*|\.\d+|\d+)(?:[eE][-+]?\d+)?', text)]
+
+
+def parse_array(source, name, rows, cols=None):
+    """Lê 'static const float NOME[...] = {...};' do header; '{{0}}' vira zeros."""
+    match = re.search(r'static const float %s\b[^=]*=\s*(\{.*?\});' % name, source, re.S)
+    if not match:
+        raise ValueError(f"{name} não encontrado no header")
+    values = parse_numbers(match.group(1))
+    size = rows * (cols or 1)
+    if values == [0.0]:
+        values = [0.0] * size
+    if len(values) != size:
+        raise ValueError(f"{name}: esperados {size} valores, encontrados {len(values)}")
+    if cols is None:
+        return values
+    return [values[r * cols:(r + 1) * cols] for r in range(rows)]
+
+
+def parse_define(source, name):
+    match = re.search(r'#define\s+%s\s+([-+0-9.eE]+)f?' % name, source)
+    if not match:
+        raise ValueError(f"{name} não encontrado no header")
+    return float(match.group(1))
+
+
+def load_model(path, header_source):
+    """Retorna (W1, b1, W2, b2, W1_features, maxima)."""
+    maxima = [parse_define(header_source, macro) if macro else HUMIDITY_MAX for macro in INPUT_MAX_MACROS]
+    hidden = int(parse_define(header_source, 'HIDDEN_SIZE'))
+    if path.endswith('.json'):
+        with open(path) as f:
+            data = json.load(f)
+        W1, b1, W2, b2 = data['W1'], data['b1'], data['W2'], float(data['b2'])
+        W1_features = data.get('W1_FEATURES', [[0.0] * len(b1) for _ in range(FEATURE_SIZE)])
+    else:
+        with open(path) as f:
+            source = f.read()
+        W1 = parse_array(source, 'W1', INPUT_SIZE, hidden)
+        b1 = parse_array(source, 'b1', hidden)
+        W2 = parse_array(source, 'W2', hidden)
+        b2 = parse_numbers(re.search(r'static const float b2\s*=\s*([^;]+);', source).group(1))[0]
+        W1_features = parse_array(source, 'W1_FEATURES', FEATURE_SIZE, hidden)
+    if len(W1) != INPUT_SIZE or any(len(row) != len(b1) for row in W1) or len(W2) != len(b1):
+        raise ValueError("Formato dos pesos não confere com a rede 4xNx1")
+    return W1, b1, W2, b2, W1_features, maxima
+
+
+def c_float(value):
+    """Menor literal decimal que volta ao mesmo float32 (o formato dos pesos colados do Colab)."""
+    single = struct.unpack('f', struct.pack('f', value))[0]
+    for digits in range(6, 10):
+        text = '%.*g' % (digits, single)
+        if struct.unpack('f', struct.pack('f', float(text)))[0] == single:
+            return text
+    return '%.9g' % single
+
+
+def c_row(values):
+    return ', '.join(c_float(v) for v in values)
+
+
+def replace_once(source, pattern, replacement):
+    updated, count = re.subn(pattern, lambda _: replacement, source, count=1, flags=re.S)
+    if count != 1:
+        raise ValueError(f"Trecho '{pattern}' não encontrado no header")
+    return updated
+
+
+def write_weights(header_source, W1, b1, W2, b2, W1_features):
+    """Reescreve em ia_model.h os pesos, o bias, HIDDEN_SIZE e MODEL_FEATURE_WEIGHTS."""
+    uses_features = any(w != 0.0 for row in W1_features for w in row)
+    w1 = ',\n'.join('    {%s}' % c_row(row) for row in W1)
+    features = '{{0}}'
+    if uses_features:
+        features = '{\n%s\n}' % ',\n'.join('    {%s}' % c_row(row) for row in W1_features)
+    source = replace_once(header_source, r'#define HIDDEN_SIZE \d+', f'#define HIDDEN_SIZE {len(b1)}')
+    source = replace_once(source, r'static const float W1\[INPUT_SIZE\]\[HIDDEN_SIZE\] = \{.*?\n\};',
+                          'static const float W1[INPUT_SIZE][HIDDEN_SIZE] = {\n%s\n};' % w1)
+    source = replace_once(source, r'static const float b1\[HIDDEN_SIZE\] = \{[^;]*\};',
+                          'static const float b1[HIDDEN_SIZE] = { %s };' % c_row(b1))
+    source = replace_once(source, r'static const float W2\[HIDDEN_SIZE\] = \{[^;]*\};',
+                          'static const float W2[HIDDEN_SIZE] = { %s};' % c_row(W2))
+    source = replace_once(source, r'static const float b2 = [^;]*;', f'static const float b2 = {c_float(b2)};')
+    source = replace_once(source, r'#define MODEL_FEATURE_WEIGHTS \d', f'#define MODEL_FEATURE_WEIGHTS {int(uses_features)}')
+    return replace_once(source, r'static const float W1_FEATURES\[FEATURE_SIZE\]\[HIDDEN_SIZE\] = (?:\{\{0\}\}|\{\n.*?\n\});',
+                        f'static const float W1_FEATURES[FEATURE_SIZE][HIDDEN_SIZE] = {features};')
+
+
+def lit(value):
+    """Literal float com precisão suficiente para ida e volta em 32 bits."""
+    text = '%.9g' % value
+    if 'e' not in text and '.' not in text:
+        text += '.0'
+    return text + 'f'
+
+
+def specialize(W1, b1, W2, b2, W1_features, maxima, tolerance):
+    """Dobra a normalização, poda pesos e classifica as unidades ocultas."""
+    report = {'pruned': 0, 'dead': [], 'linear': [], 'relu': []}
+    units = []
+    for i in range(len(b1)):
+        # Pesos sobre a leitura física: x / MAX * w == x * (w / MAX); contribuição máxima = |w|
+        weights = []
+        for j in range(INPUT_SIZE):
+            w = W1[j][i]
+            if abs(w) < tolerance:
+                report['pruned'] += 1 if w != 0.0 else 0
+                weights.append(0.0)
+            else:
+                weights.append(w / maxima[j])
+        feature_weights = [row[i] if abs(row[i]) >= tolerance else 0.0 for row in W1_features]
+        report['pruned'] += sum(1 for row in W1_features if row[i] != 0.0 and abs(row[i]) < tolerance)
+
+        # Faixa da pré-ativação com cada leitura em [0, MAX] (as características não têm faixa fixa)
+        high = b1[i] + sum(max(w, 0.0) * m for w, m in zip(weights, maxima))
+        low = b1[i] + sum(min(w, 0.0) * m for w, m in zip(weights, maxima))
+        has_features = any(feature_weights)
+        if abs(W2[i]) < tolerance or (high <= 0.0 and not has_features):
+            kind = 'dead'
+        elif low >= 0.0 and not has_features:
+            kind = 'linear'
+        else:
+            kind = 'relu'
+        report[kind].append(i)
+        units.append({'index': i, 'kind': kind, 'bias': b1[i], 'weights': weights,
+                      'features': feature_weights, 'out': W2[i], 'low': low, 'high': high})
+
+    # Unidades sempre ativas viram termos lineares: sum(W2_i * (b_i + sum(w x))) dobrado numa soma só
+    linear_bias = b2 + sum(u['out'] * u['bias'] for u in units if u['kind'] == 'linear')
+    linear_weights = [sum(u['out'] * u['weights'][j] for u in units if u['kind'] == 'linear')
+                      for j in range(INPUT_SIZE)]
+    return units, linear_bias, linear_weights, report
+
+
+def mac_terms(weights, names):
+    return ''.join(f' + {name} * {lit(w)}' for w, name in zip(weights, names) if w != 0.0)
+
+
+def generate(source_name, units, linear_bias, linear_weights, report, maxima, tolerance):
+    names = ['reading[%d]' % j for j in range(INPUT_SIZE)]
+    uses_features = any(any(u['features']) for u in units if u['kind'] == 'relu')
+    lines = []
+    out = lines.append
+    out('/*')
+    out(f'* Gerado por gen_model.py a partir de {source_name}. Não editar: rode o gerador após cada retreino.')
+    out('*')
+    out('* model_predict_generated() recebe as leituras físicas (sem normalizar) e devolve o mesmo que')
+    out('* normalize_readings + model_predict_ext, com a rede desenrolada e especializada:')
+    out(f'* - tolerância de poda: {tolerance:g} ({report["pruned"]} pesos descartados)')
+    out(f'* - unidades eliminadas (ReLU nunca ativa em [0, MAX_*]): {list_or_none(report["dead"])}')
+    out(f'* - unidades sempre ativas, dobradas na saída: {list_or_none(report["linear"])}')
+    out(f'* - unidades com ReLU: {list_or_none(report["relu"])}')
+    out('*/')
+    out('')
+    out('#ifndef IA_MODEL_GEN_H')
+    out('#define IA_MODEL_GEN_H')
+    out('')
+    out('#include <math.h>')
+    out('')
+    out('#include "ia_model.h"')
+    out('')
+    out('// 0: a predição ignora as características; o chamador não precisa extraí-las')
+    out(f'#define IA_MODEL_GEN_USES_FEATURES {int(uses_features)}')
+    out('')
+    out('static inline float model_predict_generated(const float reading[INPUT_SIZE], const float features[FEATURE_SIZE]) {')
+    if not uses_features:
+        out('    (void)features;     // Pesos das características zerados / podados')
+    out(f'    float output = {lit(linear_bias)}{mac_terms(linear_weights, names)};')
+    for u in units:
+        if u['kind'] != 'relu':
+            continue
+        i = u['index']
+        feature_terms = mac_terms(u['features'], ['features[%d]' % k for k in range(FEATURE_SIZE)])
+        out(f'    float h{i} = {lit(u["bias"])}{mac_terms(u["weights"], names)}{feature_terms};')
+        out(f'    if (h{i} > 0.0f) output += h{i} * {lit(u["out"])};')
+    out('    return 1.0f / (1.0f + expf(-output));')
+    out('}')
+    out('')
+    out('#ifdef IA_MODEL_GEN_SELF_CHECK')
+    out('/* Compara com a referência numa grade steps^4 sobre [0, MAX_*] (características zeradas).')
+    out('* Retorna o erro absoluto máximo e conta as linhas com classe diferente em *class_mismatches. */')
+    out('static inline float model_generated_self_check(int steps, long *class_mismatches) {')
+    out(f'    const float maxima[INPUT_SIZE] = {{ {", ".join(lit(m) for m in maxima)} }};')
+    out('    const float features[FEATURE_SIZE] = { 0 };')
+    out('    float max_error = 0.0f;')
+    out('    *class_mismatches = 0;')
+    out('    for (long n = 0; n < (long)steps * steps * steps * steps; ++n) {')
+    out('        float reading[INPUT_SIZE], input[INPUT_SIZE];')
+    out('        long k = n;')
+    out('        for (int j = 0; j < INPUT_SIZE; ++j, k /= steps) {')
+    out('            reading[j] = input[j] = maxima[j] * (float)(k % steps) / (float)(steps - 1);')
+    out('        }')
+    out('        normalize_readings(input);')
+    out('        float expected = model_predict_ext(input, features);')
+    out('        float got = model_predict_generated(reading, features);')
+    out('        float error = fabsf(got - expected);')
+    out('        if (error > max_error) max_error = error;')
+    out('        int expected_class = (expected >= LIFE_THRESHOLD_MODERATE) + (expected >= LIFE_THRESHOLD_FAVORABLE);')
+    out('        int got_class = (got >= LIFE_THRESHOLD_MODERATE) + (got >= LIFE_THRESHOLD_FAVORABLE);')
+    out('        *class_mismatches += expected_class != got_class;')
+    out('    }')
+    out('    return max_error;')
+    out('}')
+    out('#endif // IA_MODEL_GEN_SELF_CHECK')
+    out('')
+    out('#endif // IA_MODEL_GEN_H')
+    return '\n'.join(lines) + '\n'
+
+
+def list_or_none(items):
+    return ', '.join(str(i) for i in items) if items else 'nenhuma'
+
+
+CHECK_PROGRAM = r'''
+#define IA_MODEL_GEN_SELF_CHECK
+#include <stdio.h>
+#include <time.h>
+#include "%(header)s"
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(void) {
+    long mismatches;
+    float max_error = model_generated_self_check(41, &mismatches);
+    const float features[FEATURE_SIZE] = { 0 };
+    volatile float sink = 0.0f;
+    const long runs = 2000000;
+
+    double start = now_ns();
+    for (long n = 0; n < runs; ++n) {
+        float input[INPUT_SIZE] = { 25.0f + (n & 15), 60.0f, 80.0f, 500.0f + (n & 255) };
+        normalize_readings(input);
+        sink += model_predict_ext(input, features);
+    }
+    double reference_ns = (now_ns() - start) / runs;
+    start = now_ns();
+    for (long n = 0; n < runs; ++n) {
+        float reading[INPUT_SIZE] = { 25.0f + (n & 15), 60.0f, 80.0f, 500.0f + (n & 255) };
+        sink += model_predict_generated(reading, features);
+    }
+    double generated_ns = (now_ns() - start) / runs;
+
+    printf("erro maximo %.3g, classes diferentes %ld, referencia %.1f ns, gerado %.1f ns\n",
+           max_error, mismatches, reference_ns, generated_ns);
+    (void)sink;
+    return max_error > %(max_error)s || mismatches > 0;
+}
+'''
+
+
+def run_check(output_path, max_error, reference_header):
+    """Compila o auto-teste no host com o gcc e retorna o código de saída. A referência
+    (model_predict_ext) é compilada num diretório temporário com reference_header no lugar de
+    ia_model.h, para comparar com os mesmos pesos do header gerado."""
+    with tempfile.TemporaryDirectory() as tmp:
+        for name in ('ia_model.c', 'ia_features.c', 'ia_features.h'):
+            shutil.copy(os.path.join(HERE, name), tmp)
+        with open(os.path.join(tmp, 'ia_model.h'), 'w') as f:
+            f.write(reference_header)
+        shutil.copy(output_path, os.path.join(tmp, 'ia_model_gen.h'))
+        program = os.path.join(tmp, 'check.c')
+        binary = os.path.join(tmp, 'check')
+        with open(program, 'w') as f:
+            f.write(CHECK_PROGRAM.replace('%(max_error)s', repr(max_error) + 'f')
+                    .replace('%(header)s', 'ia_model_gen.h'))
+        command = ['gcc', '-O2', '-DIA_MODEL_NO_EXAMPLE', '-I', tmp, '-o', binary, program,
+                   os.path.join(tmp, 'ia_model.c'), os.path.join(tmp, 'ia_features.c'), '-lm']
+        subprocess.run(command, check=True)
+        return subprocess.run([binary]).returncode
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gera ia_model_gen.h com a predição especializada")
+    parser.add_argument('weights', nargs='?', default=os.path.join(HERE, 'ia_model.h'),
+                        help="ia_model.h ou JSON exportado do Colab (padrão: ia_model.h)")
+    parser.add_argument('-o', '--output', default=os.path.join(HERE, 'ia_model_gen.h'))
+    parser.add_argument('--tolerance', type=float, default=1e-4,
+                        help="contribuição máxima abaixo da qual um peso é descartado")
+    parser.add_argument('--check', action='store_true', help="compila e roda o auto-teste com o gcc")
+    parser.add_argument('--max-error', type=float, default=1e-5, help="erro máximo aceito no auto-teste")
+    parser.add_argument('--keep-header', action='store_true',
+                        help="com um JSON, não reescreve os pesos de ia_model.h")
+    args = parser.parse_args()
+
+    header_path = os.path.join(HERE, 'ia_model.h')
+    with open(header_path) as f:
+        header_source = f.read()
+    W1, b1, W2, b2, W1_features, maxima = load_model(args.weights, header_source)
+    reference_header = header_source
+    if args.weights.endswith('.json'):
+        reference_header = write_weights(header_source, W1, b1, W2, b2, W1_features)
+        if args.keep_header:
+            print(f"Aviso: {header_path} mantém os pesos antigos; model_predict (/sensores), libia_model.so "
+                  "e model_conformance vão divergir do pipeline até o header ser atualizado.", file=sys.stderr)
+        elif reference_header != header_source:
+            with open(header_path, 'w') as f:
+                f.write(reference_header)
+            print(f"{header_path}: pesos atualizados a partir de {os.path.basename(args.weights)} "
+                  "(recompile libia_model.so e rode o model_conformance)")
+    units, linear_bias, linear_weights, report = specialize(W1, b1, W2, b2, W1_features, maxima, args.tolerance)
+    code = generate(os.path.basename(args.weights), units, linear_bias, linear_weights, report, maxima, args.tolerance)
+    with open(args.output, 'w') as f:
+        f.write(code)
+
+    print(f"{args.output}: {len(report['relu'])} ReLU, {len(report['linear'])} lineares, "
+          f"{len(report['dead'])} eliminadas, {report['pruned']} pesos podados")
+    if args.check:
+        sys.exit(run_check(args.output, args.max_error, reference_header))
+
+
+if __name__ == '__main__':
+    main()
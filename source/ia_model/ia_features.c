@@ -0,0 +1,147 @@
+#include "ia_features.h"
+
+
+/* Recalcula as somas a partir do buffer para evitar o acúmulo de erro de arredondamento.
+* Executado uma vez a cada 'size' amostras, então o custo amortizado continua O(1). */
+static void window_resync(SlidingWindow *w) {
+    w->sum = 0.0f;
+    w->sum_sq = 0.0f;
+    w->sum_kx = 0.0f;
+    for (int k = 0; k < w->count; ++k) {
+        float x = w->buffer[(w->head + k) % w->size];
+        w->sum += x;
+        w->sum_sq += x * x;
+        w->sum_kx += (float)k * x;
+    }
+    w->since_resync = 0;
+}
+
+static void window_init(SlidingWindow *w, float *buffer, int size) {
+    w->buffer = buffer;
+    w->size = size;
+    w->count = 0;
+    w->head = 0;
+    w->since_resync = 0;
+    w->sum = 0.0f;
+    w->sum_sq = 0.0f;
+    w->sum_kx = 0.0f;
+}
+
+static void window_push(SlidingWindow *w, float x) {
+    if (w->count < w->size) {
+        // Janela ainda enchendo: a nova amostra recebe o índice k = count
+        w->buffer[(w->head + w->count) % w->size] = x;
+        w->sum_kx += (float)w->count * x;
+        w->sum += x;
+        w->sum_sq += x * x;
+        w->count++;
+    } else {
+        // Janela cheia: sai a mais antiga (k = 0), as demais descem um índice
+        // e a nova entra com k = size - 1. Σk·x' = Σk·x - (Σx - x0) + (size - 1)·x
+        float oldest = w->buffer[w->head];
+        w->buffer[w->head] = x;
+        w->head = (w->head + 1) % w->size;
+        w->sum_kx += (float)(w->size - 1) * x - (w->sum - oldest);
+        w->sum += x - oldest;
+        w->sum_sq += x * x - oldest * oldest;
+    }
+
+    if (++w->since_resync >= w->size) {
+        window_resync(w);
+    }
+}
+
+static float window_mean(const SlidingWindow *w) {
+    return w->count > 0 ? w->sum / (float)w->count : 0.0f;
+}
+
+static float window_variance(const SlidingWindow *w) {
+    if (w->count < 2) {
+        return 0.0f;
+    }
+    float mean = w->sum / (float)w->count;
+    float variance = w->sum_sq / (float)w->count - mean * mean;
+    return variance > 0.0f ? variance : 0.0f;
+}
+
+/* Inclinação da reta de mínimos quadrados, em unidades normalizadas por passo da grade.
+* Com k = 0..n-1: slope = (Σk·x - (n-1)/2 · Σx) · 12 / (n·(n² - 1)) */
+static float window_slope(const SlidingWindow *w) {
+    if (w->count < 2) {
+        return 0.0f;
+    }
+    float n = (float)w->count;
+    return (w->sum_kx - 0.5f * (n - 1.0f) * w->sum) * 12.0f / (n * (n * n - 1.0f));
+}
+
+void features_init(FeatureState *state) {
+    for (int c = 0; c < FEATURE_CHANNELS; ++c) {
+        window_init(&state->windows[c][0], state->short_buffer[c], FEATURE_WINDOW_SHORT);
+        window_init(&state->windows[c][1], state->long_buffer[c], FEATURE_WINDOW_LONG);
+    }
+    for (int c = 0; c < FEATURE_CHANNELS; ++c) {
+        state->last_x[c] = 0.0f;
+    }
+    state->last_ms = 0;
+    state->next_ms = 0;
+    state->clock_started = 0;
+}
+
+/* Incorpora uma nova leitura normalizada em todas as janelas */
+void features_push(FeatureState *state, const float x[FEATURE_CHANNELS]) {
+    for (int c = 0; c < FEATURE_CHANNELS; ++c) {
+        for (int w = 0; w < FEATURE_WINDOWS; ++w) {
+            window_push(&state->windows[c][w], x[c]);
+        }
+    }
+}
+
+/* Incorpora a leitura feita em now_ms (millis()) na grade de FEATURE_SAMPLE_MS: cada passo da grade
+* entre a leitura anterior e esta recebe a interpolação linear das duas; com o intervalo menor que o
+* passo, algumas leituras não geram passo nenhum. Depois de uma lacuna maior que a janela longa
+* (sistema desligado) as janelas são reenchidas só com esta leitura. Retorna quantos passos venceram. */
+int features_push_at(FeatureState *state, const float x[FEATURE_CHANNELS], unsigned long now_ms) {
+    if (!state->clock_started) {
+        state->clock_started = 1;
+        state->next_ms = now_ms;
+        state->last_ms = now_ms;
+    }
+    int steps = 0;
+    // Diferenças com sinal: atravessam a volta do millis()
+    long span = (long)(now_ms - state->last_ms);
+    if ((long)(state->next_ms - now_ms) < 0
+        && (unsigned long)span > (unsigned long)FEATURE_WINDOW_LONG * FEATURE_SAMPLE_MS) {
+        for (int i = 0; i < FEATURE_WINDOW_LONG; ++i) {
+            features_push(state, x);
+        }
+        steps = FEATURE_WINDOW_LONG;
+        state->next_ms = now_ms + FEATURE_SAMPLE_MS;
+    }
+    while ((long)(now_ms - state->next_ms) >= 0) {
+        float t = span > 0 ? (float)(long)(state->next_ms - state->last_ms) / (float)span : 1.0f;
+        float point[FEATURE_CHANNELS];
+        for (int c = 0; c < FEATURE_CHANNELS; ++c) {
+            point[c] = state->last_x[c] + (x[c] - state->last_x[c]) * t;
+        }
+        features_push(state, point);
+        state->next_ms += FEATURE_SAMPLE_MS;
+        steps++;
+    }
+    for (int c = 0; c < FEATURE_CHANNELS; ++c) {
+        state->last_x[c] = x[c];
+    }
+    state->last_ms = now_ms;
+    return steps;
+}
+
+/* Preenche o vetor de características na ordem [canal][janela][média, inclinação, variância] */
+void features_extract(const FeatureState *state, float out[FEATURE_SIZE]) {
+    for (int c = 0; c < FEATURE_CHANNELS; ++c) {
+        for (int w = 0; w < FEATURE_WINDOWS; ++w) {
+            const SlidingWindow *window = &state->windows[c][w];
+            out[FEATURE_INDEX(c, w, FEATURE_MEAN)] = window_mean(window);
+            out[FEATURE_INDEX(c, w, FEATURE_SLOPE)] = window_slope(window);
+            out[FEATURE_INDEX(c, w, FEATURE_VARIANCE)] = window_variance(window);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/*
+* Extração de características temporais das leituras dos sensores.
+*
+* Para cada canal (temperatura, umidade, gás e luz) são mantidas janelas deslizantes
+* com tamanho definido em tempo de compilação, de forma que todos os buffers são
+* alocados estaticamente dentro de FeatureState. Cada janela guarda um buffer circular
+* e somas acumuladas (Σx, Σx² e Σk·x), então cada nova amostra é incorporada em O(1)
+* e a média, a inclinação (regressão linear) e a variância saem direto das somas.
+*
+* As leituras devem ser empurradas já normalizadas (saída de normalize_readings),
+* assim as características ficam na mesma escala das entradas do modelo.
+*
+* As janelas andam numa grade fixa de FEATURE_SAMPLE_MS, independente do intervalo adaptativo
+* de leitura (adaptive_rate.h): features_push_at interpola linearmente entre a leitura anterior e
+* a atual em cada passo da grade que caiu entre as duas. Assim as janelas cobrem sempre o mesmo
+* tempo e a inclinação tem sempre a mesma unidade, em qualquer taxa.
+*/
+
+#ifndef IA_FEATURES_H
+#define IA_FEATURES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FEATURE_CHANNELS 4        // Mesmo número de entradas do modelo (INPUT_SIZE)
+
+/* Grade das janelas e tamanho delas (em passos da grade) */
+#define FEATURE_SAMPLE_MS 500     // Passo da grade (o intervalo base de leitura)
+#define FEATURE_WINDOW_SHORT 8    // 8 x 0,5s = 4s
+#define FEATURE_WINDOW_LONG 32    // 32 x 0,5s = 16s
+#define FEATURE_WINDOWS 2
+
+/* Características por janela: média, inclinação (por passo de FEATURE_SAMPLE_MS) e variância */
+#define FEATURES_PER_WINDOW 3
+#define FEATURE_MEAN 0
+#define FEATURE_SLOPE 1
+#define FEATURE_VARIANCE 2
+
+// Tamanho do vetor de características: [canal][janela][característica]
+#define FEATURE_SIZE (FEATURE_CHANNELS * FEATURE_WINDOWS * FEATURES_PER_WINDOW)
+#define FEATURE_INDEX(channel, window, feature) \
+    (((channel) * FEATURE_WINDOWS + (window)) * FEATURES_PER_WINDOW + (feature))
+
+/* Janela deslizante sobre um canal */
+typedef struct {
+    float *buffer;      // Buffer circular (aponta para o armazenamento em FeatureState)
+    int size;           // Capacidade da janela
+    int count;          // Amostras válidas (até size)
+    int head;           // Posição da amostra mais antiga
+    int since_resync;   // Amostras desde o último recálculo das somas
+    float sum;          // Σ x
+    float sum_sq;       // Σ x²
+    float sum_kx;       // Σ k·x, com k = 0 para a amostra mais antiga
+} SlidingWindow;
+
+/* Estado completo do extrator. Não deve ser copiado: as janelas apontam para os buffers internos. */
+typedef struct {
+    float short_buffer[FEATURE_CHANNELS][FEATURE_WINDOW_SHORT];
+    float long_buffer[FEATURE_CHANNELS][FEATURE_WINDOW_LONG];
+    SlidingWindow windows[FEATURE_CHANNELS][FEATURE_WINDOWS];
+    float last_x[FEATURE_CHANNELS];   // Leitura anterior, para interpolar (features_push_at)
+    unsigned long last_ms;
+    unsigned long next_ms;            // Próximo passo da grade
+    int clock_started;                // 0 até a primeira leitura com horário
+} FeatureState;
+
+/* Prototipo de funções*/
+void features_init(FeatureState *state);
+void features_push(FeatureState *state, const float x[FEATURE_CHANNELS]);
+int features_push_at(FeatureState *state, const float x[FEATURE_CHANNELS], unsigned long now_ms);
+void features_extract(const FeatureState *state, float out[FEATURE_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IA_FEATURES_H
@@ -34,6 +34,37 @@ float model_predict(const float x[INPUT_SIZE]) {
     return output;
 }
 
+// Predição da variante estendida: mesma rede, com as características temporais somadas na camada oculta
+float model_predict_ext(const float x[INPUT_SIZE], const float features[FEATURE_SIZE]) {
+#if !MODEL_FEATURE_WEIGHTS
+    (void)features;
+    return model_predict(x);
+#else
+    float hidden[HIDDEN_SIZE];
+
+    // Camada oculta (Dense + ReLU) sobre [x, features]
+    for (int i = 0; i < HIDDEN_SIZE; ++i) {
+        hidden[i] = b1[i];
+        for (int j = 0; j < INPUT_SIZE; ++j) {
+            hidden[i] += x[j] * W1[j][i];
+        }
+        for (int j = 0; j < FEATURE_SIZE; ++j) {
+            hidden[i] += features[j] * W1_FEATURES[j][i];
+        }
+        hidden[i] = relu(hidden[i]);
+    }
+
+    // Camada de saída (Dense + Sigmoid)
+    float output = b2;
+    for (int i = 0; i < HIDDEN_SIZE; ++i) {
+        output += hidden[i] * W2[i];
+    }
+    output = sigmoid(output);
+
+    return output;
+#endif
+}
+
 /* Função para normalização das leituras dos sensores*/
 void normalize_readings(float input[INPUT_SIZE]) { 
     input[0] /= MAX_TEMPERATURE_READING;  // Temperatura
@@ -42,7 +73,58 @@ void normalize_readings(float input[INPUT_SIZE]) {
     input[3] /= MAX_LIGHT_READING;       // Luz
 }
 
-/* Exemplo*/
+/* Predição em lote sobre leituras brutas (count linhas de INPUT_SIZE valores, sem normalizar).
+* As linhas são processadas em blocos de MODEL_BATCH_BLOCK transpostos, para que os laços
+* internos percorram linhas contíguas e o compilador possa vetorizá-los. */
+void model_predict_batch(const float *readings, float *out, size_t count) {
+    float x[INPUT_SIZE][MODEL_BATCH_BLOCK];
+    float hidden[MODEL_BATCH_BLOCK];
+    float output[MODEL_BATCH_BLOCK];
+
+    for (size_t start = 0; start < count; start += MODEL_BATCH_BLOCK) {
+        size_t n = count - start < MODEL_BATCH_BLOCK ? count - start : MODEL_BATCH_BLOCK;
+
+        // Normalização (a mesma de model_predict) + transposição do bloco
+        for (size_t r = 0; r < n; ++r) {
+            float row[INPUT_SIZE];
+            for (int j = 0; j < INPUT_SIZE; ++j) {
+                row[j] = readings[(start + r) * INPUT_SIZE + j];
+            }
+            normalize_readings(row);
+            for (int j = 0; j < INPUT_SIZE; ++j) {
+                x[j][r] = row[j];
+            }
+        }
+        for (size_t r = 0; r < n; ++r) {
+            output[r] = b2;
+        }
+
+        // Camada oculta (Dense + ReLU), acumulando direto na saída
+        for (int i = 0; i < HIDDEN_SIZE; ++i) {
+            for (size_t r = 0; r < n; ++r) {
+                hidden[r] = b1[i];
+            }
+            for (int j = 0; j < INPUT_SIZE; ++j) {
+                float w = W1[j][i];
+                for (size_t r = 0; r < n; ++r) {
+                    hidden[r] += x[j][r] * w;
+                }
+            }
+            for (size_t r = 0; r < n; ++r) {
+                output[r] += relu(hidden[r]) * W2[i];
+            }
+        }
+
+        // Camada de saída (Sigmoid)
+        for (size_t r = 0; r < n; ++r) {
+            out[start + r] = sigmoid(output[r]);
+        }
+    }
+}
+
+/* Exemplo (desativado com -DIA_MODEL_NO_EXAMPLE quando ia_model.c é ligado a outros programas;
+* nos sketches do Arduino, que têm setup/loop, fica de fora sozinho) */
+#if !defined(IA_MODEL_NO_EXAMPLE) && !defined(ARDUINO)
 
 int main() {
     // Substitua pelos valores reais dos sensores (normalizados conforme usado no treino)
@@ -50,5 +132,17 @@ int main() {
     normalize_readings(readings);
     float chance_vida = model_predict(readings);
     printf("Porcentagem de chance de vida: %.2f%%\n", chance_vida * 100.0f);
+
+    // Variante estendida: alimenta as janelas com a mesma leitura e prediz com as características
+    FeatureState features;
+    float feature_vector[FEATURE_SIZE];
+    features_init(&features);
+    for (int i = 0; i < FEATURE_WINDOW_LONG; ++i) {
+        features_push(&features, readings);
+    }
+    features_extract(&features, feature_vector);
+    float chance_vida_ext = model_predict_ext(readings, feature_vector);
+    printf("Porcentagem de chance de vida (estendido): %.2f%%\n", chance_vida_ext * 100.0f);
     return 0;
-}
\ No newline at end of file
+}
+#endif // IA_MODEL_NO_EXAMPLE
@@ -18,8 +18,11 @@
 #define IA_MODEL_H
 
 #include <stdio.h>
+#include <stddef.h>
 #include <math.h>
 
+#include "ia_features.h"
+
 
 #define INPUT_SIZE 4    // Número de entradas (sensores)
 #define HIDDEN_SIZE 8   // Número de neurônios na camada oculta
@@ -30,32 +33,60 @@
 #define MAX_TEMPERATURE_READING 50.0f
 #define MAX_LIGHT_READING 1086.46
 
+/* Limiares de classificação usados no loop() do firmware */
+#define LIFE_THRESHOLD_FAVORABLE 0.70f  // Propício à vida
+#define LIFE_THRESHOLD_MODERATE 0.5f    // Condição moderada
+
+/* Linhas processadas juntas por model_predict_batch */
+#define MODEL_BATCH_BLOCK 64
+
 
 /* Pesos e bias do modelo treinado*/
 
 // Pesos e bias da camada oculta (Dense + ReLU)
 // W1: Matriz de pesos da camada oculta
 // b1: Vetor de bias da camada oculta
-const float W1[INPUT_SIZE][HIDDEN_SIZE] = {
+static const float W1[INPUT_SIZE][HIDDEN_SIZE] = {
     {0.76127756, -1.14999, -1.3243964, 1.0532789, -0.5648892, -0.35137573, -0.02234721, -0.97573954},
     {0.0390515, 0.19636367, 0.04113916, -0.27672333, 1.0549195, 0.55996454, -0.11504948, 1.0107998},
     {0.0651774, 0.07326719, -0.0230303, -0.08702946, -0.38678792, -0.68653685, 0.03985898, 0.3901636},
     {-1.0542206, 0.10372138, -0.2699437, 0.5364545, -0.02500459, -0.50767237, 0.790702, -0.15410507}
 };
 
-const float b1[HIDDEN_SIZE] = { 0.23017338, 0.32451043, 0.7052842, -0.37595168, 0.09138247, 0.06862238, -0.2987081, 0.32811505 };
+static const float b1[HIDDEN_SIZE] = { 0.23017338, 0.32451043, 0.7052842, -0.37595168, 0.09138247, 0.06862238, -0.2987081, 0.32811505 };
 
 // Pesos e bias da camada de saída (Dense + Sigmoid)
 // W2: Vetor de pesos da camada de saída
 // b2: Escalar de bias da camada de saída
-const float W2[HIDDEN_SIZE] = { -2.3351076, -1.8962342, -4.0220113, -0.7348212, 1.2856134, 1.095262, -1.9509647, 1.2919254};
+static const float W2[HIDDEN_SIZE] = { -2.3351076, -1.8962342, -4.0220113, -0.7348212, 1.2856134, 1.095262, -1.9509647, 1.2919254};
+
+static const float b2 = 0.2667996;
 
-const float b2 = 0.2667996;
+// Variante com entradas estendidas (leitura instantânea + características temporais de ia_features.h)
+// W1_FEATURES: Pesos das características temporais na camada oculta, na ordem de FEATURE_INDEX.
+// Zerados até o retreino com o dataset de janelas: com eles zerados, model_predict_ext
+// produz exatamente o mesmo resultado que model_predict.
+// MODEL_FEATURE_WEIGHTS: 1 com os pesos treinados (gen_model.py reescreve este bloco a partir do JSON
+// exportado). Com 0, model_predict_ext não gasta as multiplicações das características (é o próprio
+// model_predict).
+#define MODEL_FEATURE_WEIGHTS 0
+
+static const float W1_FEATURES[FEATURE_SIZE][HIDDEN_SIZE] = {{0}};
+
+/* Prototipo de funções (ligação C, para o .ino em C++ e os módulos .c usarem as mesmas funções)*/
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-/* Prototipo de funções*/
 float relu(float x);
 float sigmoid(float x);
 float model_predict(const float x[INPUT_SIZE]);
+float model_predict_ext(const float x[INPUT_SIZE], const float features[FEATURE_SIZE]);
 void normalize_readings(float input[INPUT_SIZE]);
+void model_predict_batch(const float *readings, float *out, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // IA_MODEL_H
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+* Gerado por gen_model.py a partir de ia_model.h. Não editar: rode o gerador após cada retreino.
+*
+* model_predict_generated() recebe as leituras físicas (sem normalizar) e devolve o mesmo que
+* normalize_readings + model_predict_ext, com a rede desenrolada e especializada:
+* - tolerância de poda: 0.0001 (0 pesos descartados)
+* - unidades eliminadas (ReLU nunca ativa em [0, MAX_*]): nenhuma
+* - unidades sempre ativas, dobradas na saída: nenhuma
+* - unidades com ReLU: 0, 1, 2, 3, 4, 5, 6, 7
+*/
+
+#ifndef IA_MODEL_GEN_H
+#define IA_MODEL_GEN_H
+
+#include <math.h>
+
+#include "ia_model.h"
+
+// 0: a predição ignora as características; o chamador não precisa extraí-las
+#define IA_MODEL_GEN_USES_FEATURES 0
+
+static inline float model_predict_generated(const float reading[INPUT_SIZE], const float features[FEATURE_SIZE]) {
+    (void)features;     // Pesos das características zerados / podados
+    float output = 0.2667996f;
+    float h0 = 0.23017338f + reading[0] * 0.0152255512f + reading[1] * 0.000390515f + reading[2] * 0.000299267184f + reading[3] * -0.000970326197f;
+    if (h0 > 0.0f) output += h0 * -2.3351076f;
+    float h1 = 0.32451043f + reading[0] * -0.0229998f + reading[1] * 0.0019636367f + reading[2] * 0.000336412094f + reading[3] * 9.54672791e-05f;
+    if (h1 > 0.0f) output += h1 * -1.8962342f;
+    float h2 = 0.7052842f + reading[0] * -0.026487928f + reading[1] * 0.0004113916f + reading[2] * -0.000105745443f + reading[3] * -0.000248461701f;
+    if (h2 > 0.0f) output += h2 * -4.0220113f;
+    float h3 = -0.37595168f + reading[0] * 0.021065578f + reading[1] * -0.0027672333f + reading[2] * -0.000399602645f + reading[3] * 0.000493763691f;
+    if (h3 > 0.0f) output += h3 * -0.7348212f;
+    float h4 = 0.09138247f + reading[0] * -0.011297784f + reading[1] * 0.010549195f + reading[2] * -0.00177596731f + reading[3] * -2.30147359e-05f;
+    if (h4 > 0.0f) output += h4 * 1.2856134f;
+    float h5 = 0.06862238f + reading[0] * -0.0070275146f + reading[1] * 0.0055996454f + reading[2] * -0.00315228821f + reading[3] * -0.00046727203f;
+    if (h5 > 0.0f) output += h5 * 1.095262f;
+    float h6 = -0.2987081f + reading[0] * -0.0004469442f + reading[1] * -0.0011504948f + reading[2] * 0.000183015657f + reading[3] * 0.000727778289f;
+    if (h6 > 0.0f) output += h6 * -1.9509647f;
+    float h7 = 0.32811505f + reading[0] * -0.0195147908f + reading[1] * 0.010107998f + reading[2] * 0.00179146701f + reading[3] * -0.000141841458f;
+    if (h7 > 0.0f) output += h7 * 1.2919254f;
+    return 1.0f / (1.0f + expf(-output));
+}
+
+#ifdef IA_MODEL_GEN_SELF_CHECK
+/* Compara com a referência numa grade steps^4 sobre [0, MAX_*] (características zeradas).
+* Retorna o erro absoluto máximo e conta as linhas com classe diferente em *class_mismatches. */
+static inline float model_generated_self_check(int steps, long *class_mismatches) {
+    const float maxima[INPUT_SIZE] = { 50.0f, 100.0f, 217.79f, 1086.46f };
+    const float features[FEATURE_SIZE] = { 0 };
+    float max_error = 0.0f;
+    *class_mismatches = 0;
+    for (long n = 0; n < (long)steps * steps * steps * steps; ++n) {
+        float reading[INPUT_SIZE], input[INPUT_SIZE];
+        long k = n;
+        for (int j = 0; j < INPUT_SIZE; ++j, k /= steps) {
+            reading[j] = input[j] = maxima[j] * (float)(k % steps) / (float)(steps - 1);
+        }
+        normalize_readings(input);
+        float expected = model_predict_ext(input, features);
+        float got = model_predict_generated(reading, features);
+        float error = fabsf(got - expected);
+        if (error > max_error) max_error = error;
+        int expected_class = (expected >= LIFE_THRESHOLD_MODERATE) + (expected >= LIFE_THRESHOLD_FAVORABLE);
+        int got_class = (got >= LIFE_THRESHOLD_MODERATE) + (got >= LIFE_THRESHOLD_FAVORABLE);
+        *class_mismatches += expected_class != got_class;
+    }
+    return max_error;
+}
+#endif // IA_MODEL_GEN_SELF_CHECK
+
+#endif // IA_MODEL_GEN_H
@@ -0,0 +1,55 @@
+#include "ia_model_lib.h"
+
+#include <math.h>
+
+#include "ia_model.h"
+
+
+/* FNV-1a de 32 bits sobre os bytes de um bloco */
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t ia_model_abi_version(void) {
+    return IA_MODEL_ABI_VERSION;
+}
+
+uint32_t ia_model_input_size(void) {
+    return INPUT_SIZE;
+}
+
+/* Impressão digital dos pesos e da normalização compilados: muda a cada retreino */
+uint32_t ia_model_fingerprint(void) {
+    const float maxima[INPUT_SIZE] = { MAX_TEMPERATURE_READING, 100.0f, MAX_GAS_READING, (float)MAX_LIGHT_READING };
+    uint32_t hash = 2166136261u;
+    hash = fnv1a(hash, W1, sizeof(W1));
+    hash = fnv1a(hash, b1, sizeof(b1));
+    hash = fnv1a(hash, W2, sizeof(W2));
+    hash = fnv1a(hash, &b2, sizeof(b2));
+    hash = fnv1a(hash, W1_FEATURES, sizeof(W1_FEATURES));
+    return fnv1a(hash, maxima, sizeof(maxima));
+}
+
+int ia_model_score_batch(const float *readings, float *scores, size_t count) {
+    if (count == 0) {
+        return IA_MODEL_OK;
+    }
+    if (!readings || !scores) {
+        return IA_MODEL_ERR_ARGS;
+    }
+    model_predict_batch(readings, scores, count);
+
+    // relu(NaN) é 0: sem isso uma leitura ausente viraria uma chance de vida plausível
+    for (size_t r = 0; r < count; ++r) {
+        const float *row = readings + r * INPUT_SIZE;
+        if (isnan(row[0]) || isnan(row[1]) || isnan(row[2]) || isnan(row[3])) {
+            scores[r] = NAN;
+        }
+    }
+    return IA_MODEL_OK;
+}
@@ -0,0 +1,51 @@
+/*
+* Interface de biblioteca compartilhada do modelo (libia_model.so), para o broker pontuar no servidor
+* as leituras que chegam dos robôs com o mesmo código C do firmware.
+*
+* ABI estável: só tipos C de tamanho fixo, sem structs, e só as funções abaixo exportadas (o resto é
+* compilado com -fvisibility=hidden). Uma mudança incompatível nas funções incrementa
+* IA_MODEL_ABI_VERSION; quem carrega a biblioteca confere ia_model_abi_version() antes de usá-la.
+* ia_model_fingerprint() identifica os pesos compilados, para saber com que modelo o servidor pontuou.
+*
+* Compilar (a partir de source/ia_model):
+*   gcc -O3 -shared -fPIC -fvisibility=hidden -DIA_MODEL_NO_EXAMPLE -o libia_model.so \
+*       ia_model_lib.c ia_model.c ia_features.c -lm
+*/
+
+#ifndef IA_MODEL_LIB_H
+#define IA_MODEL_LIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define IA_MODEL_ABI_VERSION 1
+
+#if defined(__GNUC__)
+#define IA_MODEL_API __attribute__((visibility("default")))
+#else
+#define IA_MODEL_API
+#endif
+
+/* Códigos de retorno de ia_model_score_batch */
+#define IA_MODEL_OK 0
+#define IA_MODEL_ERR_ARGS -1    // Ponteiro nulo com count > 0
+
+/* Prototipo de funções*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+IA_MODEL_API uint32_t ia_model_abi_version(void);
+IA_MODEL_API uint32_t ia_model_input_size(void);
+IA_MODEL_API uint32_t ia_model_fingerprint(void);
+
+/* Pontua count linhas de leituras físicas (temperatura, umidade, gás, luz; float32, uma linha após a
+* outra) em scores[count]. Linha com alguma leitura ausente (NaN) recebe NaN. Não guarda estado: pode
+* ser chamada de várias threads ao mesmo tempo. */
+IA_MODEL_API int ia_model_score_batch(const float *readings, float *scores, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IA_MODEL_LIB_H
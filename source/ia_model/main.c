@@ -1,4 +1,4 @@
-// Executar no Arduino IDE com o arq ia_model.h no mesmo diretório
+// Executar no Arduino IDE com os arq ia_model.h, ia_model.c e ia_features.h no mesmo diretório
 
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
@@ -70,32 +70,7 @@ void handleTelegramMessages();
 void sendTelegramLifeMessage(float temp, float hum, float gas, float lux, float life_chance, const char* terrain_status);
 void sendTakePhotoCommandToBroker(); 
 
-float relu(float x) { return x > 0 ? x : 0; }
-float sigmoid(float x) { return 1.0f / (1.0f + expf(-x)); }
-
-float model_predict(const float x[INPUT_SIZE]) {
-  float hidden[HIDDEN_SIZE];
-  for (int i = 0; i < HIDDEN_SIZE; ++i) {
-    hidden[i] = b1[i];
-    for (int j = 0; j < INPUT_SIZE; ++j) {
-      hidden[i] += x[j] * W1[j][i];
-    }
-    hidden[i] = relu(hidden[i]);
-  }
-
-  float output = b2;
-  for (int i = 0; i < HIDDEN_SIZE; ++i) {
-    output += hidden[i] * W2[i];
-  }
-  return sigmoid(output);
-}
-
-void normalize_readings(float input[INPUT_SIZE]) {
-  input[0] /= MAX_TEMPERATURE_READING;
-  input[1] /= 100.0f; 
-  input[2] /= MAX_GAS_READING;
-  input[3] /= MAX_LIGHT_READING;
-}
+// relu, sigmoid, model_predict e normalize_readings vêm de ia_model.c (conferidos em source/host/model_conformance.c)
 
 
 void setup() {